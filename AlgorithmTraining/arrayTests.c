@@ -2,8 +2,19 @@
 // License: Academic Free License ("AFL") v. 3.0
 // AFL License page: http://opensource.org/licenses/AFL-3.0
 
+// Defines the VeeLib operation counters when built with -DVL_COUNT_OPS
+#define VL_COUNT_OPS_IMPL
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <VeeLib/VeeLib.h>
+
+// Elements per block of `partitionBlock`: offsets fit in an unsigned char
+#define PARTITION_BLOCK 64
+
+// Segments this short are sorted by insertion sort in `quickSortBounded`
+#define QUICKSORT_THRESHOLD 16
 
 void printArray(int* mA, int mASize)
 {
@@ -15,6 +26,8 @@ void printArray(int* mA, int mASize)
 void swap(int* mA, int* mB)
 {
     int temp = *mA;
+
+    VL_OPS_SWAP();
     *mA = *mB;
     *mB = temp;
 }
@@ -23,10 +36,10 @@ int partition(int* mA, int mLB, int mUB, int mPivot)
 {
     while(mLB < mUB)
     {
-        while(mA[mLB] < mPivot) ++mLB;
-        while(mA[mUB] > mPivot) --mUB;
+        while(VL_OPS_CMP(mA[mLB] < mPivot)) ++mLB;
+        while(VL_OPS_CMP(mA[mUB] > mPivot)) --mUB;
 
-        if(mA[mLB] == mA[mUB])
+        if(VL_OPS_CMP(mA[mLB] == mA[mUB]))
             ++mLB;
         else if(mLB < mUB)
             swap(&mA[mLB], &mA[mUB]);
@@ -45,20 +58,206 @@ void quickSort(int* mA, int mLB, int mUB)
     quickSort(mA, pIdx + 1, mUB);
 }
 
+// Three-way (Dutch national flag) partition of [mLB, mUB] around mPivot.
+// Afterwards [mLB, *mLt) < mPivot, [*mLt, *mGt] == mPivot and
+// (*mGt, mUB] > mPivot: equal elements end up in the middle and never need
+// to be sorted again.
+void partition3(int* mA, int mLB, int mUB, int mPivot, int* mLt, int* mGt)
+{
+    int lt = mLB, i = mLB, gt = mUB;
+
+    while(i <= gt)
+    {
+        if(VL_OPS_CMP(mA[i] < mPivot))
+            swap(&mA[lt++], &mA[i++]);
+        else if(VL_OPS_CMP(mA[i] > mPivot))
+            swap(&mA[i], &mA[gt--]);
+        else
+            ++i;
+    }
+
+    *mLt = lt;
+    *mGt = gt;
+}
+
+// Block partition (BlockQuicksort) of [mLB, mUB] around mA[mLB].
+// Both ends are scanned one block of PARTITION_BLOCK elements at a time,
+// storing without branches the offsets of the misplaced elements; the
+// offsets are then swapped in pairs. The comparisons do not depend on
+// previous ones, so there are no mispredicted branches to pay for.
+// Afterwards the pivot is at the returned index, elements on its left are
+// smaller and elements on its right are greater or equal.
+int partitionBlock(int* mA, int mLB, int mUB)
+{
+    unsigned char offsetsL[PARTITION_BLOCK], offsetsR[PARTITION_BLOCK];
+    int startL = 0, startR = 0, countL = 0, countR = 0;
+    int pivot = mA[mLB], l = mLB + 1, r = mUB, i, count;
+
+    while(r - l + 1 >= 2 * PARTITION_BLOCK)
+    {
+        if(countL == 0)
+        {
+            startL = 0;
+            for(i = 0; i < PARTITION_BLOCK; ++i)
+            {
+                offsetsL[countL] = (unsigned char)i;
+                countL += VL_OPS_CMP(mA[l + i] >= pivot);
+            }
+        }
+
+        if(countR == 0)
+        {
+            startR = 0;
+            for(i = 0; i < PARTITION_BLOCK; ++i)
+            {
+                offsetsR[countR] = (unsigned char)i;
+                countR += VL_OPS_CMP(mA[r - i] < pivot);
+            }
+        }
+
+        count = countL < countR ? countL : countR;
+        for(i = 0; i < count; ++i)
+            swap(&mA[l + offsetsL[startL + i]], &mA[r - offsetsR[startR + i]]);
+
+        countL -= count;
+        countR -= count;
+        startL += count;
+        startR += count;
+
+        if(countL == 0) l += PARTITION_BLOCK;
+        if(countR == 0) r -= PARTITION_BLOCK;
+    }
+
+    // Everything before l is smaller and everything after r is greater or
+    // equal: the few elements left in between are partitioned one by one
+    while(1)
+    {
+        while(l <= r && VL_OPS_CMP(mA[l] < pivot)) ++l;
+        while(l <= r && VL_OPS_CMP(mA[r] >= pivot)) --r;
+        if(l >= r) break;
+        swap(&mA[l++], &mA[r--]);
+    }
+
+    swap(&mA[mLB], &mA[l - 1]);
+    return l - 1;
+}
+
+void siftDown(int* mA, int mASize, int mIdx)
+{
+    int child;
+
+    while((child = 2 * mIdx + 1) < mASize)
+    {
+        if(child + 1 < mASize && VL_OPS_CMP(mA[child + 1] > mA[child])) ++child;
+        if(VL_OPS_CMP(mA[mIdx] >= mA[child])) return;
+
+        swap(&mA[mIdx], &mA[child]);
+        mIdx = child;
+    }
+}
+
+void heapSort(int* mA, int mASize)
+{
+    int i;
+
+    for(i = mASize / 2 - 1; i >= 0; --i) siftDown(mA, mASize, i);
+
+    for(i = mASize - 1; i > 0; --i)
+    {
+        swap(&mA[0], &mA[i]);
+        siftDown(mA, i, 0);
+    }
+}
+
+void insertionSort(int* mA, int mASize);
+
+// Moves the median of mA[mLB], the middle element and mA[mUB] to mLB
+void movePivot(int* mA, int mLB, int mUB)
+{
+    int mid = mLB + (mUB - mLB) / 2;
+
+    if(VL_OPS_CMP(mA[mid] < mA[mLB])) swap(&mA[mid], &mA[mLB]);
+    if(VL_OPS_CMP(mA[mUB] < mA[mid])) swap(&mA[mUB], &mA[mid]);
+    if(VL_OPS_CMP(mA[mid] < mA[mLB])) swap(&mA[mid], &mA[mLB]);
+
+    swap(&mA[mLB], &mA[mid]);
+}
+
+// mLeftmost is false when mA[mLB - 1] is known to be smaller or equal to
+// every element of [mLB, mUB] (it is a pivot of an enclosing partition)
+void quickSortBoundedImpl(int* mA, int mLB, int mUB, int mDepth, int mLeftmost)
+{
+    while(mUB - mLB + 1 > QUICKSORT_THRESHOLD)
+    {
+        int pIdx, lt, gt;
+
+        // Too many unbalanced partitions: heap sort keeps O(n log n)
+        if(mDepth-- == 0)
+        {
+            heapSort(mA + mLB, mUB - mLB + 1);
+            return;
+        }
+
+        movePivot(mA, mLB, mUB);
+
+        // The pivot equals a lower bound of the segment, so the segment is
+        // full of copies of it: a three-way partition takes them all out at
+        // once, and there is nothing smaller to sort
+        if(!mLeftmost && VL_OPS_CMP(mA[mLB - 1] == mA[mLB]))
+        {
+            partition3(mA, mLB, mUB, mA[mLB], &lt, &gt);
+            mLB = gt + 1;
+            continue;
+        }
+
+        pIdx = partitionBlock(mA, mLB, mUB);
+
+        // Recursion on the smaller side only: the stack depth is at most
+        // log2(n) and the larger side is sorted by the loop
+        if(pIdx - mLB < mUB - pIdx)
+        {
+            quickSortBoundedImpl(mA, mLB, pIdx - 1, mDepth, mLeftmost);
+            mLB = pIdx + 1;
+            mLeftmost = 0;
+        }
+        else
+        {
+            quickSortBoundedImpl(mA, pIdx + 1, mUB, mDepth, 0);
+            mUB = pIdx - 1;
+        }
+    }
+
+    if(mUB > mLB) insertionSort(mA + mLB, mUB - mLB + 1);
+}
+
+// Quick sort on `partitionBlock` and `partition3`. It stays O(n log n) for
+// any input, including inputs with few distinct values, and uses
+// O(log n) stack.
+void quickSortBounded(int* mA, int mLB, int mUB)
+{
+    int depth = 0, size;
+
+    for(size = mUB - mLB + 1; size > 1; size /= 2) depth += 2;
+    quickSortBoundedImpl(mA, mLB, mUB, depth, 1);
+}
+
 void insertionSort(int* mA, int mASize)
 {
     int i, j;
 
     for(i = 1; i < mASize; ++i)
-        for(j = i; j > 0 && mA[j - 1] > mA[j]; --j) swap(&mA[j], &mA[j - 1]);
+        for(j = i; j > 0 && VL_OPS_CMP(mA[j - 1] > mA[j]); --j)
+            swap(&mA[j], &mA[j - 1]);
 }
 
+// Sorts each of the mStep interleaved subsequences of mA: every element,
+// starting from mA[mStep], is moved back mStep positions at a time
 void insertionSortByStep(int* mA, int mASize, int mStep)
 {
     int i, j;
 
-    for(i = 1; i < mASize; i += mStep)
-        for(j = i; j > 0 && mA[j - mStep] > mA[j]; j -= mStep)
+    for(i = mStep; i < mASize; ++i)
+        for(j = i; j >= mStep && VL_OPS_CMP(mA[j - mStep] > mA[j]); j -= mStep)
             swap(&mA[j], &mA[j - mStep]);
 }
 
@@ -66,15 +265,146 @@ void shellSort(int* mA, int mLB, int mUB)
 {
     int size = mUB - mLB + 1;
     int step = size;
-    int i;
 
     while(step > 1)
     {
         step /= 2;
-        insertionSortByStep(mA, size, step);
+        insertionSortByStep(mA + mLB, size, step);
+    }
+}
+
+// Shell's original gaps (n / 2, n / 4, ..., 1), O(n^2) worst case
+size_t getGapsShell(size_t mSize, size_t* mGaps)
+{
+    size_t count = 0, gap, i;
+
+    for(gap = mSize / 2; gap > 0 && count < VLA_SHELL_MAX_GAPS; gap /= 2)
+        mGaps[count++] = gap;
+
+    // Increasing order, as VlaGapFn requires
+    for(i = 0; i < count / 2; ++i)
+    {
+        size_t temp = mGaps[i];
+        mGaps[i] = mGaps[count - 1 - i];
+        mGaps[count - 1 - i] = temp;
+    }
+
+    return count;
+}
+
+// Fills mA with one of the benchmark input distributions
+void fillArray(int* mA, int mASize, int mDistribution)
+{
+    int i;
+
+    srand(1);
+    for(i = 0; i < mASize; ++i)
+    {
+        switch(mDistribution)
+        {
+            case 0: mA[i] = rand(); break;                      // Random
+            case 1: mA[i] = i; break;                           // Sorted
+            case 2: mA[i] = mASize - i; break;                  // Reversed
+            case 3: // Organ pipe
+                mA[i] = i < mASize / 2 ? i : mASize - i;
+                break;
+            default: mA[i] = rand() % 16; break;                // Few unique
+        }
+    }
+}
+
+// Compares the gap sequences on the library's vla_sortShellGapsI. Built
+// with -DVL_COUNT_OPS it also prints the comparisons and moves (array
+// writes) it counts, and the times include the counting
+void benchmarkShellGaps()
+{
+    const char* gapNames[] = {"Shell", "Ciura", "Tokuda", "Sedgewick"};
+    VlaGapFn gapFns[] = {&getGapsShell, &vla_getGapsCiura, &vla_getGapsTokuda,
+        &vla_getGapsSedgewick};
+    const char* distributionNames[] = {
+        "random", "sorted", "reversed", "organ pipe", "few unique"};
+    int sizes[] = {1000, 100000, 1000000};
+    int s, d, g;
+
+#ifdef VL_COUNT_OPS
+    printf("%-10s %-10s %-9s %14s %14s %10s\n", "size", "input", "gaps",
+        "comparisons", "moves", "time (s)");
+#else
+    printf("%-10s %-10s %-9s %10s\n", "size", "input", "gaps", "time (s)");
+#endif
+
+    for(s = 0; s < 3; ++s)
+    {
+        int* array = (int*)malloc(sizes[s] * sizeof(int));
+        if(array == NULL) return;
+
+        for(d = 0; d < 5; ++d)
+            for(g = 0; g < 4; ++g)
+            {
+                size_t gaps[VLA_SHELL_MAX_GAPS];
+                size_t gapCount = (*gapFns[g])(sizes[s], gaps);
+                clock_t begin;
+                double seconds;
+
+                fillArray(array, sizes[s], d);
+                vlops_reset();
+                begin = clock();
+                vla_sortShellGapsI(array, sizes[s], gaps, gapCount);
+                seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+                printf("%-10d %-10s %-9s ", sizes[s], distributionNames[d],
+                    gapNames[g]);
+#ifdef VL_COUNT_OPS
+                printf("%14llu %14llu ", vlops_get().comparisons,
+                    vlops_get().moves);
+#endif
+                printf("%10f\n", seconds);
+            }
+
+        free(array);
     }
 }
 
+#ifdef VL_COUNT_OPS
+// Prints the operations counted by VL_COUNT_OPS for the sorts, on the same
+// input of mASize elements with mDistinct distinct values (`quickSort` is
+// left out: it does not terminate on every input)
+void countOperations(int mASize, int mDistinct)
+{
+    const char* names[] = {"quickSortBounded", "shellSort", "vla_sortShellI",
+        "vla_sortSelectionI"};
+    int* array = (int*)malloc(mASize * sizeof(int));
+    int s, i;
+
+    if(array == NULL) return;
+
+    printf("%d elements, %d distinct:\n", mASize, mDistinct);
+
+    for(s = 0; s < 4; ++s)
+    {
+        VlOps ops;
+
+        srand(1);
+        for(i = 0; i < mASize; ++i) array[i] = rand() % mDistinct;
+
+        vlops_reset();
+        switch(s)
+        {
+            case 0: quickSortBounded(array, 0, mASize - 1); break;
+            case 1: shellSort(array, 0, mASize - 1); break;
+            case 2: vla_sortShellI(array, mASize, NULL); break;
+            default: vla_sortSelectionI(array, mASize); break;
+        }
+        ops = vlops_get();
+
+        printf("\t%-20s %10llu comparisons %10llu swaps %10llu moves\n",
+            names[s], ops.comparisons, ops.swaps, ops.moves);
+    }
+
+    free(array);
+}
+#endif
+
 int main()
 {
     {
@@ -102,4 +432,58 @@ int main()
             printArray(array, arraySize);
         }
     }
+
+    {
+        int array[] = {4, 1, 6, 33, 5, 2, 19, 1, 6, 3, 9, 10, 34, 32, 11, 20};
+        int arraySize = sizeof(array) / sizeof(array[0]);
+        int lt, gt;
+
+        {
+            partition3(array, 0, arraySize - 1, 6, &lt, &gt);
+            printArray(array, arraySize);
+            printf("lt: %d, gt: %d\n", lt, gt);
+        }
+
+        {
+            quickSortBounded(array, 0, arraySize - 1);
+            printArray(array, arraySize);
+        }
+    }
+
+#ifdef VL_COUNT_OPS
+    countOperations(2000, 1000000);
+    countOperations(2000, 1000);
+#endif
+
+    benchmarkShellGaps();
+
+    {
+        // Few distinct values over many elements
+        int size = 10000000, distinct[] = {2, 16, 1000, size};
+        int* array = (int*)malloc(size * sizeof(int));
+        int i, d, sorted;
+        clock_t begin;
+
+        if(array == NULL) return 1;
+
+        for(d = 0; d < 4; ++d)
+        {
+            srand(1);
+            for(i = 0; i < size; ++i) array[i] = rand() % distinct[d];
+
+            begin = clock();
+            quickSortBounded(array, 0, size - 1);
+
+            for(i = 1, sorted = 1; i < size; ++i)
+                sorted &= array[i - 1] <= array[i];
+
+            printf("%d elements, %d distinct: %f s, %s\n", size, distinct[d],
+                (double)(clock() - begin) / CLOCKS_PER_SEC,
+                sorted ? "sorted" : "NOT sorted");
+        }
+
+        free(array);
+    }
+
+    return 0;
 }
@@ -1,3 +1,3 @@
 #!/bin/bash
 
-clang -O3 -DNDEBUG -lm ./$1 -o /tmp/$1.temp && /tmp/$1.temp
\ No newline at end of file
+clang -O3 -DNDEBUG -pthread -lm ./$1 -o /tmp/$1.temp && /tmp/$1.temp
\ No newline at end of file
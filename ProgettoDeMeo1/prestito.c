@@ -5,8 +5,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 #include <VeeLib/VeeLib.h>
 
+// Months are limited to 2^LOAN_MONTHS_BITS by the batch functions
+#define LOAN_MONTHS_BITS 12
+#define LOAN_MAX_THREADS 64
+#define LOAN_BLOCK_SIZE 256
+
+// Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer
+#define LOAN_ROUNDER 6755399441055744.0
+
 /// @brief Structure used as a return type for debt functions.
 typedef struct
 {
@@ -20,6 +29,10 @@ double calculateVariableMonthlyRate(double mDebt, double mRate)
     return mDebt * mRate;
 }
 double calculateFixedRate(double mDebt, double mRate) { return mRate; }
+double calculateMixedRate(double mDebt, double mRate)
+{
+    return mRate + mDebt * 0.01;
+}
 
 /// @brief Calculates paid rate and remaining debt.
 /// @param mDebt Current debt.
@@ -92,6 +105,199 @@ double calculateRequiredFixedRate(
     return lb;
 }
 
+/// @brief Returns the fixed rate that pays off `mDebt` in exactly
+/// `mExpectedMonths` months, in closed form.
+/// @details Every month the rate is paid first, then the monthly interest is
+/// applied to the remaining debt (see `getRemainingDebt`). With q = 1 + i:
+///     D(n) = D * q^n - R * (q + q^2 + ... + q^n)
+/// Solving D(n) = 0 for R gives R = D * i * q^(n - 1) / (q^n - 1).
+double calculateAnnuityRate(
+    double mDebt, double mAnnualInterest, int mExpectedMonths)
+{
+    assert(mExpectedMonths > 0);
+
+    double monthlyInterest = mAnnualInterest / 12.0;
+    if(monthlyInterest == 0.0) return mDebt / mExpectedMonths;
+
+    double qn1 = pow(1.0 + monthlyInterest, mExpectedMonths - 1);
+    return mDebt * monthlyInterest * qn1 /
+           (qn1 * (1.0 + monthlyInterest) - 1.0);
+}
+
+/// @brief Returns the debt left after `mMonths` months, or a value <= 0 if
+/// the debt was paid off earlier.
+double simulateRemainingDebt(double mDebt, double mRate,
+    double mAnnualInterest, double (*mRateFn)(double, double), int mMonths)
+{
+    int m;
+    DebtResult currentResult;
+    currentResult.remainingDebt = mDebt;
+
+    for(m = 0; m < mMonths && currentResult.remainingDebt > 0.0; ++m)
+        currentResult = getRemainingDebt(
+            currentResult.remainingDebt, mRate, mAnnualInterest, mRateFn);
+
+    return currentResult.remainingDebt;
+}
+
+/// @brief Returns the smallest rate value, within `mTolerance`, that pays
+/// off `mDebt` in `mExpectedMonths` with any rate calculation function.
+/// @details `mRateFn` must pay more for greater rate values. The solution is
+/// bracketed by doubling an upper bound, then found by bisection: every step
+/// halves the bracket at the cost of one `simulateRemainingDebt` call.
+/// For fixed rates, `calculateAnnuityRate` gives the exact value directly.
+double solveRequiredRate(double mDebt, double mAnnualInterest,
+    int mExpectedMonths, double (*mRateFn)(double, double), double mTolerance)
+{
+    assert(mExpectedMonths > 0);
+    assert(mTolerance > 0.0);
+
+    double lb = 0.0, ub = 1.0, mid;
+
+    while(simulateRemainingDebt(
+              mDebt, ub, mAnnualInterest, mRateFn, mExpectedMonths) > 0.0)
+    {
+        assert(ub < HUGE_VAL);
+        lb = ub;
+        ub *= 2.0;
+    }
+
+    while(ub - lb > mTolerance)
+    {
+        mid = lb + (ub - lb) / 2.0;
+
+        if(simulateRemainingDebt(
+               mDebt, mid, mAnnualInterest, mRateFn, mExpectedMonths) > 0.0)
+            lb = mid;
+        else
+            ub = mid;
+    }
+
+    return ub;
+}
+
+/// @brief Structure of arrays describing a loan portfolio.
+typedef struct
+{
+    const double* debts;
+    const double* annualInterests;
+    const int* months; // In [1, 2^LOAN_MONTHS_BITS]
+    double* rates;     // Output: fixed rate of every loan
+    size_t count;
+} LoanPortfolio;
+
+/// @brief Computes the annuity rates of the loans in [mBegin, mEnd).
+/// @details Branch-free version of `calculateAnnuityRate`. Loans are
+/// processed in blocks: q^(n - 1) is computed by binary exponentiation over
+/// a fixed number of bits, one bit at a time for the whole block, so every
+/// inner loop is independent across loans and is vectorized.
+/// Note: 1 + bit * (q^(2^k) - 1) can differ from q^(2^k) by one ulp, the
+/// total relative error stays below 1e-12.
+void calculateAnnuityRatesRange(
+    const LoanPortfolio* mPortfolio, size_t mBegin, size_t mEnd)
+{
+    double monthlyInterests[LOAN_BLOCK_SIZE], bases[LOAN_BLOCK_SIZE],
+        qn1s[LOAN_BLOCK_SIZE], exponents[LOAN_BLOCK_SIZE];
+    size_t blockSize, i;
+    int bit;
+
+    for(; mBegin < mEnd; mBegin += blockSize)
+    {
+        const double* debts = mPortfolio->debts + mBegin;
+        const double* annualInterests = mPortfolio->annualInterests + mBegin;
+        const int* months = mPortfolio->months + mBegin;
+        double* rates = mPortfolio->rates + mBegin;
+
+        blockSize = mEnd - mBegin < LOAN_BLOCK_SIZE ? mEnd - mBegin
+                                                    : LOAN_BLOCK_SIZE;
+
+        for(i = 0; i < blockSize; ++i)
+        {
+            // Longer loans would silently lose the high bits of the exponent
+            assert(months[i] >= 1 && months[i] <= 1 << LOAN_MONTHS_BITS);
+
+            monthlyInterests[i] = annualInterests[i] / 12.0;
+            bases[i] = 1.0 + monthlyInterests[i];
+            qn1s[i] = 1.0;
+            exponents[i] = months[i] - 1;
+        }
+
+        for(bit = 0; bit < LOAN_MONTHS_BITS; ++bit)
+            for(i = 0; i < blockSize; ++i)
+            {
+                // Exponents are kept as doubles, so that the loop does not mix
+                // lane widths: floor(e / 2) is computed by rounding e / 2 -
+                // 1/4 to the nearest integer
+                double half = ((exponents[i] * 0.5 - 0.25) + LOAN_ROUNDER) -
+                              LOAN_ROUNDER;
+                double bitValue = exponents[i] - 2.0 * half;
+
+                qn1s[i] *= 1.0 + bitValue * (bases[i] - 1.0);
+                bases[i] *= bases[i];
+                exponents[i] = half;
+            }
+
+        for(i = 0; i < blockSize; ++i)
+        {
+            // Without interest the formula degenerates to 0 / 0: in that
+            // case it is turned into (D / n) / 1 arithmetically, as a branch
+            // would prevent vectorization
+            double q = 1.0 + monthlyInterests[i];
+            double noInterest = monthlyInterests[i] == 0.0;
+
+            rates[i] = (debts[i] * monthlyInterests[i] * qn1s[i] +
+                           noInterest * debts[i] / months[i]) /
+                       (qn1s[i] * q - 1.0 + noInterest);
+        }
+    }
+}
+
+// Implementation structure for `calculateAnnuityRatesParallel`
+typedef struct
+{
+    const LoanPortfolio* portfolio;
+    size_t begin, end;
+} LoanTask;
+
+void* runLoanTask(void* mTask)
+{
+    LoanTask* task = (LoanTask*)mTask;
+    calculateAnnuityRatesRange(task->portfolio, task->begin, task->end);
+    return NULL;
+}
+
+/// @brief Computes the annuity rates of a whole portfolio, splitting it in
+/// `mThreadCount` contiguous chunks.
+/// @details The calling thread processes the last chunk. If a thread cannot
+/// be created, its chunk is processed by the calling thread as well.
+void calculateAnnuityRatesParallel(
+    const LoanPortfolio* mPortfolio, int mThreadCount)
+{
+    assert(mThreadCount > 0 && mThreadCount <= LOAN_MAX_THREADS);
+
+    pthread_t threads[LOAN_MAX_THREADS];
+    int started[LOAN_MAX_THREADS];
+    LoanTask tasks[LOAN_MAX_THREADS];
+    size_t chunk = mPortfolio->count / mThreadCount;
+    int t;
+
+    for(t = 0; t < mThreadCount; ++t)
+    {
+        tasks[t].portfolio = mPortfolio;
+        tasks[t].begin = t * chunk;
+        tasks[t].end =
+            (t == mThreadCount - 1) ? mPortfolio->count : (t + 1) * chunk;
+
+        started[t] = t < mThreadCount - 1 &&
+                     pthread_create(&threads[t], NULL, &runLoanTask,
+                         &tasks[t]) == 0;
+        if(!started[t]) runLoanTask(&tasks[t]);
+    }
+
+    for(t = 0; t < mThreadCount; ++t)
+        if(started[t]) pthread_join(threads[t], NULL);
+}
+
 // Example methods that print the steps required to pay a loan
 void printDebtForAnYear(
     double mDebt, double mAnnualInterest, double mVariableMonthlyRate)
@@ -153,4 +359,48 @@ int main()
     printf("\n");
     printf("Required fixed rate test: %f\n",
         calculateRequiredFixedRate(4213, 0.2, 5));
+    printf("Annuity fixed rate test: %f\n", calculateAnnuityRate(4213, 0.2, 5));
+    printf("Solved fixed rate test: %f\n",
+        solveRequiredRate(4213, 0.2, 5, &calculateFixedRate, 1e-6));
+    printf("Solved mixed rate test: %f\n",
+        solveRequiredRate(4213, 0.2, 5, &calculateMixedRate, 1e-6));
+    printf("\n");
+
+    {
+        size_t count = 1000000, i;
+        double* debts = (double*)malloc(count * sizeof(double));
+        double* annualInterests = (double*)malloc(count * sizeof(double));
+        int* months = (int*)malloc(count * sizeof(int));
+        double* rates = (double*)malloc(count * sizeof(double));
+        double maxError = 0.0;
+
+        if(!debts || !annualInterests || !months || !rates) return 1;
+
+        for(i = 0; i < count; ++i)
+        {
+            debts[i] = 1000.0 + rand() % 100000;
+            annualInterests[i] = (rand() % 300) / 1000.0;
+            months[i] = 1 + rand() % 360;
+        }
+
+        LoanPortfolio portfolio = {
+            debts, annualInterests, months, rates, count};
+        calculateAnnuityRatesParallel(&portfolio, 4);
+
+        for(i = 0; i < count; ++i)
+            maxError = vlm_getMaxD(maxError,
+                fabs(rates[i] - calculateAnnuityRate(debts[i],
+                                    annualInterests[i], months[i])) /
+                    rates[i]);
+
+        printf("Portfolio of %d loans, max relative error: %g\n", (int)count,
+            maxError);
+
+        free(debts);
+        free(annualInterests);
+        free(months);
+        free(rates);
+    }
+
+    return 0;
 }
\ No newline at end of file
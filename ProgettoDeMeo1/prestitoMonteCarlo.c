@@ -0,0 +1,256 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <VeeLib/VeeLib.h>
+
+#define MC_MAX_THREADS 64
+
+// Percentiles reported by `printDistribution`
+#define MC_PERCENTILE_COUNT 7
+
+/// @brief Parameters of a Monte Carlo loan simulation.
+/// @details The annual interest follows a mean-reverting random walk, updated
+/// every month:
+///     r' = r + reversion * (meanInterest - r) + volatility * Z
+/// where Z is a standard normal shock. Negative interests are clamped to 0.
+/// Every month the fixed `rate` is paid first, then the monthly interest is
+/// applied to the remaining debt, like `getRemainingDebt` in prestito.c
+/// does. Unlike `getRemainingDebt`, no interest is applied once the payment
+/// brings the debt to zero or below: the overpayment of the last month is
+/// not credited with (negative) interest.
+typedef struct
+{
+    double debt;
+    double rate;
+    double startInterest;
+    double meanInterest;
+    double reversion;
+    double volatility;
+    int maxMonths;
+    size_t pathCount;
+    unsigned long long seed;
+} McParams;
+
+/// @brief Per-path results of a Monte Carlo loan simulation.
+/// @details A path that does not pay off the debt in `maxMonths` months
+/// reports `maxMonths + 1` months.
+typedef struct
+{
+    int* monthsToPayOff;
+    double* totalInterests;
+} McResults;
+
+/// @brief Counter-based random number generator (SplitMix64 finalizer).
+/// @details Returns the `mCounter`-th number of the stream identified by
+/// `mKey`. Having no state, any number of the stream can be generated
+/// directly: each path derives its numbers from its own index, so results
+/// do not depend on how paths are split among threads.
+unsigned long long mcRandom(
+    unsigned long long mKey, unsigned long long mCounter)
+{
+    unsigned long long z = mKey + (mCounter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// @brief Returns a uniform float in (0, 1], built from the top 24 bits.
+float mcToUnitF(unsigned long long mBits)
+{
+    return ((mBits >> 40) + 1) * (1.f / 16777216.f);
+}
+
+/// @brief Simulates the paths in [mBegin, mEnd), writing their results.
+/// @details Tight kernel: the rate calculation is inlined instead of going
+/// through a function pointer, and normal shocks are produced in pairs by
+/// the Box-Muller transform using the vlpoly_ minimax functions.
+void mcSimulateRange(const McParams* mParams, const McResults* mResults,
+    size_t mBegin, size_t mEnd)
+{
+    size_t path;
+
+    for(path = mBegin; path < mEnd; ++path)
+    {
+        unsigned long long key = mcRandom(mParams->seed, path);
+        double debt = mParams->debt, interest = mParams->startInterest;
+        double totalInterest = 0.0;
+        float shocks[2] = {0.f, 0.f};
+        int m;
+
+        for(m = 0; m < mParams->maxMonths && debt > 0.0; ++m)
+        {
+            if(m % 2 == 0)
+            {
+                unsigned long long bits = mcRandom(key, m / 2);
+                float radius = sqrtf(-2.f * vlpoly_logF(mcToUnitF(bits)));
+                float angle = 6.2831853f * mcToUnitF(bits << 24);
+
+                shocks[0] = radius * vlpoly_cosF(angle);
+                shocks[1] = radius * vlpoly_sinF(angle);
+            }
+
+            double newDebt = debt - mParams->rate;
+            double monthlyInterest = interest / 12.0;
+            double monthInterest =
+                newDebt > 0.0 ? newDebt * monthlyInterest : 0.0;
+
+            totalInterest += monthInterest;
+            debt = newDebt + monthInterest;
+
+            interest +=
+                mParams->reversion * (mParams->meanInterest - interest) +
+                mParams->volatility * shocks[m % 2];
+            if(interest < 0.0) interest = 0.0;
+        }
+
+        mResults->monthsToPayOff[path] =
+            debt > 0.0 ? mParams->maxMonths + 1 : m;
+        mResults->totalInterests[path] = totalInterest;
+    }
+}
+
+// Implementation structure for `mcSimulate`
+typedef struct
+{
+    const McParams* params;
+    const McResults* results;
+    size_t begin, end;
+} McTask;
+
+void* mcRunTask(void* mTask)
+{
+    McTask* task = (McTask*)mTask;
+    mcSimulateRange(task->params, task->results, task->begin, task->end);
+    return NULL;
+}
+
+/// @brief Simulates all the paths, splitting them in `mThreadCount`
+/// contiguous chunks.
+/// @details The calling thread simulates the last chunk. If a thread cannot
+/// be created, its chunk is simulated by the calling thread as well.
+void mcSimulate(
+    const McParams* mParams, const McResults* mResults, int mThreadCount)
+{
+    assert(mThreadCount > 0 && mThreadCount <= MC_MAX_THREADS);
+
+    pthread_t threads[MC_MAX_THREADS];
+    int started[MC_MAX_THREADS];
+    McTask tasks[MC_MAX_THREADS];
+    size_t chunk = mParams->pathCount / mThreadCount;
+    int t;
+
+    for(t = 0; t < mThreadCount; ++t)
+    {
+        tasks[t].params = mParams;
+        tasks[t].results = mResults;
+        tasks[t].begin = t * chunk;
+        tasks[t].end =
+            (t == mThreadCount - 1) ? mParams->pathCount : (t + 1) * chunk;
+
+        started[t] = t < mThreadCount - 1 &&
+                     pthread_create(&threads[t], NULL, &mcRunTask, &tasks[t]) ==
+                         0;
+        if(!started[t]) mcRunTask(&tasks[t]);
+    }
+
+    for(t = 0; t < mThreadCount; ++t)
+        if(started[t]) pthread_join(threads[t], NULL);
+}
+
+int compareDoubles(const void* mA, const void* mB)
+{
+    double a = *(const double*)mA, b = *(const double*)mB;
+    return (a > b) - (a < b);
+}
+
+/// @brief Prints percentiles of months to pay off and total interest.
+/// @details Months are bounded, so their percentiles come from a counting
+/// pass over a histogram. Interests are sorted in place.
+/// @return Returns 1 in case of error (no paths, or out of memory).
+int printDistribution(const McParams* mParams, const McResults* mResults)
+{
+    static const double percentiles[MC_PERCENTILE_COUNT] = {
+        0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+
+    size_t* histogram;
+    size_t i, cumulative;
+    int p, m;
+
+    // Percentile ranks are computed from pathCount - 1
+    if(mParams->pathCount == 0) return 1;
+
+    histogram = (size_t*)calloc(mParams->maxMonths + 2, sizeof(size_t));
+    if(histogram == NULL) return 1;
+
+    for(i = 0; i < mParams->pathCount; ++i)
+        ++histogram[mResults->monthsToPayOff[i]];
+
+    qsort(mResults->totalInterests, mParams->pathCount, sizeof(double),
+        &compareDoubles);
+
+    vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
+    printf("Percentile\tMonths\tTotal interest\n");
+    vlc_resetFmt();
+
+    for(p = 0; p < MC_PERCENTILE_COUNT; ++p)
+    {
+        size_t rank = (size_t)(percentiles[p] * (mParams->pathCount - 1));
+
+        for(m = 0, cumulative = histogram[0]; cumulative <= rank; ++m)
+            cumulative += histogram[m + 1];
+
+        printf("%.0f%%\t\t%s%d\t%f\n", percentiles[p] * 100.0,
+            m > mParams->maxMonths ? ">" : "",
+            m > mParams->maxMonths ? mParams->maxMonths : m,
+            mResults->totalInterests[rank]);
+    }
+
+    printf("Not paid off in %d months: %f%%\n", mParams->maxMonths,
+        100.0 * histogram[mParams->maxMonths + 1] / mParams->pathCount);
+
+    free(histogram);
+    return 0;
+}
+
+int main()
+{
+    McParams params;
+    params.debt = 100000.0;
+    params.rate = 1000.0;
+    params.startInterest = 0.05;
+    params.meanInterest = 0.06;
+    params.reversion = 0.02;
+    params.volatility = 0.002;
+    params.maxMonths = 360;
+    params.pathCount = 1000000;
+    params.seed = 12345;
+
+    McResults results;
+    results.monthsToPayOff = (int*)malloc(params.pathCount * sizeof(int));
+    results.totalInterests =
+        (double*)malloc(params.pathCount * sizeof(double));
+
+    if(results.monthsToPayOff == NULL || results.totalInterests == NULL)
+        return 1;
+
+    vlc_setFmt(vlc_StyleBold, vlc_ColorGreen);
+    printf("Simulating %d rate paths:\n", (int)params.pathCount);
+    vlc_resetFmt();
+    printf("\tDebt            -> %f\n", params.debt);
+    printf("\tFixed rate      -> %f\n", params.rate);
+    printf("\tStart interest  -> %f\n", params.startInterest);
+    printf("\tMean interest   -> %f\n\n", params.meanInterest);
+
+    mcSimulate(&params, &results, 4);
+    if(printDistribution(&params, &results) != 0) return 1;
+
+    free(results.monthsToPayOff);
+    free(results.totalInterests);
+    return 0;
+}
@@ -22,20 +22,21 @@ typedef struct
 //	    n < 5
 //  5 < n < 8
 // 		n = 9
-// 10 < n < 15
-// 15 < n < 20
-// 20 < n < 24
-// 		n = 27
-// 		n = 29
-// 		n = 37
+// 		n = 11, 12
+// 		n = 14
+// 		n = 17
+// 		n = 19
+// 		n = 22
+// 		n = 27 (Frobenius number: every greater n is solvable)
 
 // 5a + 8b + 24c = n
 // is a diophantine equation.
 // Usually, such an equation has solutions if GCD(5, 8, 24) divides n.
 // However, that takes into account negative values for a, b or c, which
 // do not make sense for this hypotetical pen-buying situation.
-// Thus, the only reliable way I found to determine impossible values is brute
-// force.
+// `solvePenProblem` determines impossible values by brute force, while
+// `CoinSolver` (see below) precomputes them once for any set of
+// denominations.
 
 /// @brief Initializes and returns a new instance of an ABC struct.
 ABC createABC()
@@ -98,25 +99,230 @@ ABC solvePenProblem(int mN)
     return r;
 }
 
-void solveAndPrint(int mN)
+/// @brief Precomputed solver for a * x + b * y + c * z + ... = n, with
+/// non-negative unknowns, for any set of positive denominations.
+/// @details For every residue r modulo the smallest denomination m, the
+/// solver stores the smallest representable number congruent to r, together
+/// with the counts that represent it. n is then representable if and only
+/// if it is at least the stored value for n mod m: the difference is filled
+/// with denominations of value m.
+typedef struct
+{
+    int* coins;
+    int coinCount;
+    int smallestIdx;         // Index of the smallest denomination
+    long long* minReachable; // Per residue, -1 if unreachable
+    long long* counts;       // Per residue, `coinCount` counts
+} CoinSolver;
+
+int getGCD(int mA, int mB)
+{
+    while(mB != 0)
+    {
+        int temp = mA % mB;
+        mA = mB;
+        mB = temp;
+    }
+
+    return mA;
+}
+
+/// @brief Releases the memory owned by a solver.
+void destroyCoinSolver(CoinSolver* mS)
 {
-    ABC result = solvePenProblem(mN);
+    free(mS->coins);
+    free(mS->minReachable);
+    free(mS->counts);
+    mS->coins = NULL;
+    mS->minReachable = NULL;
+    mS->counts = NULL;
+}
+
+/// @brief Builds the residue table for the denominations in `mCoins`.
+/// @details Uses the round-robin algorithm (Boecker & Liptak): denominations
+/// are added one at a time, and every cycle of residues that a denomination
+/// connects is walked once, starting from its minimum (which can never be
+/// improved), relaxing the smallest reachable numbers.
+/// Cost: O(coinCount^2 * smallest coin).
+/// @return Returns 1 in case of error.
+int createCoinSolver(CoinSolver* mS, const int* mCoins, int mCoinCount)
+{
+    int i, j, smallest, residueCount;
+    long long r;
+
+    assert(mCoinCount > 0);
+
+    mS->coinCount = mCoinCount;
+    mS->smallestIdx = 0;
+    for(i = 0; i < mCoinCount; ++i)
+    {
+        assert(mCoins[i] > 0);
+        if(mCoins[i] < mCoins[mS->smallestIdx]) mS->smallestIdx = i;
+    }
+
+    residueCount = smallest = mCoins[mS->smallestIdx];
+
+    mS->coins = (int*)malloc(mCoinCount * sizeof(int));
+    mS->minReachable = (long long*)malloc(residueCount * sizeof(long long));
+    mS->counts = (long long*)calloc(
+        (size_t)residueCount * mCoinCount, sizeof(long long));
+
+    if(!mS->coins || !mS->minReachable || !mS->counts)
+    {
+        destroyCoinSolver(mS);
+        return 1;
+    }
+
+    for(i = 0; i < mCoinCount; ++i) mS->coins[i] = mCoins[i];
+    for(r = 0; r < residueCount; ++r) mS->minReachable[r] = -1;
+    mS->minReachable[0] = 0;
+
+    for(i = 0; i < mCoinCount; ++i)
+    {
+        int coin = mCoins[i], gcd, cycle, p;
+        if(i == mS->smallestIdx) continue;
+
+        gcd = getGCD(smallest, coin);
+        cycle = smallest / gcd;
+
+        // Residues connected by `coin` form `gcd` cycles, p, p + coin,
+        // p + 2 * coin, ... (mod smallest): each cycle is walked starting
+        // from its smallest reachable number
+        for(p = 0; p < gcd; ++p)
+        {
+            long long current = -1;
+            int currentRes = -1, res, step;
+
+            for(res = p; res < smallest; res += gcd)
+                if(mS->minReachable[res] != -1 &&
+                    (current == -1 || mS->minReachable[res] < current))
+                {
+                    current = mS->minReachable[res];
+                    currentRes = res;
+                }
+
+            if(current == -1) continue;
+
+            for(step = 1; step < cycle; ++step)
+            {
+                long long* countsFrom;
+                long long* countsTo;
+
+                current += coin;
+                res = (int)(current % smallest);
+
+                if(mS->minReachable[res] != -1 &&
+                    mS->minReachable[res] <= current)
+                {
+                    current = mS->minReachable[res];
+                    currentRes = res;
+                    continue;
+                }
+
+                mS->minReachable[res] = current;
+
+                countsFrom = &mS->counts[(size_t)currentRes * mCoinCount];
+                countsTo = &mS->counts[(size_t)res * mCoinCount];
+                for(j = 0; j < mCoinCount; ++j) countsTo[j] = countsFrom[j];
+                ++countsTo[i];
+
+                currentRes = res;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/// @brief Returns true if `mN` can be represented, in O(1).
+bool isRepresentable(const CoinSolver* mS, long long mN)
+{
+    long long min;
+    if(mN < 0) return false;
+
+    min = mS->minReachable[mN % mS->coins[mS->smallestIdx]];
+    return min != -1 && min <= mN;
+}
+
+/// @brief Writes in `mCounts` how many of each denomination represent `mN`.
+/// @return Returns 1 if `mN` cannot be represented.
+int solveCoinProblem(const CoinSolver* mS, long long mN, long long* mCounts)
+{
+    int smallest = mS->coins[mS->smallestIdx], j;
+    long long res;
+
+    if(!isRepresentable(mS, mN)) return 1;
+
+    res = mN % smallest;
+    for(j = 0; j < mS->coinCount; ++j)
+        mCounts[j] = mS->counts[res * mS->coinCount + j];
+
+    mCounts[mS->smallestIdx] += (mN - mS->minReachable[res]) / smallest;
+    return 0;
+}
+
+/// @brief Returns the largest non-representable number (Frobenius number).
+/// @return Returns -1 if every number is representable, -2 if there are
+/// infinitely many non-representable numbers (the denominations share a
+/// common divisor greater than 1).
+long long getFrobeniusNumber(const CoinSolver* mS)
+{
+    int smallest = mS->coins[mS->smallestIdx], r;
+    long long max = 0;
+
+    for(r = 0; r < smallest; ++r)
+    {
+        if(mS->minReachable[r] == -1) return -2;
+        if(mS->minReachable[r] > max) max = mS->minReachable[r];
+    }
+
+    return max - smallest;
+}
+
+/// @brief Checks every number in [mBegin, mEnd) for representability.
+/// @details The residue is advanced incrementally instead of being
+/// recomputed with a division for every number.
+/// @param mTarget Array of (mEnd - mBegin) values, set to true for
+/// representable numbers.
+void solveCoinProblemRange(
+    const CoinSolver* mS, long long mBegin, long long mEnd, bool* mTarget)
+{
+    int smallest = mS->coins[mS->smallestIdx];
+    long long n, res;
+
+    if(mBegin < 0)
+    {
+        for(n = mBegin; n < 0 && n < mEnd; ++n) mTarget[n - mBegin] = false;
+        mTarget += n - mBegin;
+        mBegin = n;
+    }
+
+    for(n = mBegin, res = mBegin % smallest; n < mEnd; ++n)
+    {
+        long long min = mS->minReachable[res];
+        *mTarget++ = min != -1 && min <= n;
+        if(++res == smallest) res = 0;
+    }
+}
+
+void solveAndPrint(const CoinSolver* mS, int mN, bool mValid)
+{
+    long long r[3];
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Solve:\t5 * a + 8 * b + 24 * c = %d\n", mN);
 
     vlc_resetFmt();
 
-    if(result.valid == 0)
+    if(mValid && solveCoinProblem(mS, mN, r) == 0)
     {
-        printf("----->\t5 * %d + 8 * %d + 24 * %d = %d\n", result.a, result.b,
-            result.c, mN);
-        printf("----->\t%d + %d + %d = %d\n", 5 * result.a, 8 * result.b,
-            24 * result.c, mN);
+        printf("----->\t5 * %lld + 8 * %lld + 24 * %lld = %d\n", r[0], r[1],
+            r[2], mN);
+        printf("----->\t%lld + %lld + %lld = %d\n", 5 * r[0], 8 * r[1],
+            24 * r[2], mN);
 
         vlc_setFmt(vlc_StyleBold, vlc_ColorGreen);
-        printf("----->\t%d = %d\n", 5 * result.a + 8 * result.b + 24 * result.c,
-            mN);
+        printf("----->\t%lld = %d\n", 5 * r[0] + 8 * r[1] + 24 * r[2], mN);
     }
     else
     {
@@ -130,6 +336,25 @@ void solveAndPrint(int mN)
 
 int main()
 {
+    int coins[] = {5, 8, 24};
+    bool valid[100];
+    CoinSolver solver;
     int i;
-    for(i = 0; i < 100; ++i) solveAndPrint(i);
-}
\ No newline at end of file
+
+    if(createCoinSolver(&solver, coins, 3) != 0) return 1;
+
+    // The whole range is checked with a single call, then the precomputed
+    // solutions are checked against the brute force solver
+    solveCoinProblemRange(&solver, 0, 100, valid);
+
+    for(i = 0; i < 100; ++i)
+    {
+        VL_EXPECT(valid[i] == (solvePenProblem(i).valid == 0));
+        solveAndPrint(&solver, i, valid[i]);
+    }
+
+    printf("Frobenius number: %lld\n", getFrobeniusNumber(&solver));
+
+    destroyCoinSolver(&solver);
+    return 0;
+}
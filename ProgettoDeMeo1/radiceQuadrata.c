@@ -140,5 +140,15 @@ int main()
         "Cubic root of 756: %f\n", myCubicRootAlg1(756, ep1, step1, &tempItr));
     printf("Iterations: %d\n\n", tempItr);
 
+    vlc_setFmt(vlc_StyleBold, vlc_ColorGreen);
+    printf("Exact integer root tests:\n");
+    vlc_resetFmt();
+    printf("Integer sqrt of 312: %lu\n", vlm_isqrtUL(312));
+    printf("Integer sqrt of 2^64 - 1: %lu\n", vlm_isqrtUL(ULONG_MAX));
+    printf("Integer cubic root of 756: %lu\n", vlm_icbrtUL(756));
+    printf("Integer cubic root of 2^64 - 1: %lu\n", vlm_icbrtUL(ULONG_MAX));
+    printf("Is 2^52 + 2^27 + 1 a perfect square? %d\n",
+        vlm_isPerfectSquareUL(4503599761588225UL));
+
     return 0;
 }
\ No newline at end of file
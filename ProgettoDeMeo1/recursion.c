@@ -135,4 +135,18 @@ int main()
     printf("sin(3.14 * 1.2): %f\n", sinMcLaurinRecursive(3.14 * 1.2, 9));
     printf("sin(3.14 * 1.4): %f\n", sinMcLaurinRecursive(3.14 * 1.4, 9));
     printf("sin(3.14 * 1.6): %f\n", sinMcLaurinRecursive(3.14 * 1.6, 9));
+
+    vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
+    printf("Minimax sin value tests:\n");
+    vlc_resetFmt();
+    {
+        float xs[8], sins[8];
+        int i;
+
+        for(i = 0; i < 8; ++i) xs[i] = 3.14f * 0.2f * (i + 1);
+        vlpoly_sinArrayF(xs, sins, 8);
+
+        for(i = 0; i < 8; ++i)
+            printf("sin(3.14 * %.1f): %f\n", 0.2f * (i + 1), sins[i]);
+    }
 }
\ No newline at end of file
@@ -1,19 +1,89 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Con VL_COUNT_OPS le ricerche, gli inserimenti e le discese verso
+// minimo, massimo, successore e predecessore contano confronti e nodi
+// visitati, e le rotazioni contano come spostamenti, nei contatori di
+// VeeLib (serve -I../VeeLib/include); altrimenti le macro non generano
+// codice
+#ifdef VL_COUNT_OPS
+#define VL_COUNT_OPS_IMPL
+#include <VeeLib/Global/Common.h>
+#else
+#define VL_OPS_CMP(mExpr) (mExpr)
+#define VL_OPS_MOVE(mCount) ((void)0)
+#define VL_OPS_VISIT() ((void)0)
+#endif
 
 struct AlberoImpl;
 typedef struct AlberoImpl Albero;
 
+#define ALBERO_NERO 0
+#define ALBERO_ROSSO 1
+
+// Con ALBERO_AUMENTATO ogni nodo memorizza anche dimensione ed altezza del
+// proprio sottoalbero, aggiornate da tutte le funzioni che modificano la
+// struttura dell'albero: permettono albero_Rank, albero_Select ed
+// albero_CountLess in O(altezza) ed albero_getAltezza in O(1), al costo di
+// 8 byte per nodo. Compilando con -DALBERO_AUMENTATO=0 il nodo resta di
+// 32 byte.
+#ifndef ALBERO_AUMENTATO
+#define ALBERO_AUMENTATO 1
+#endif
+
 struct AlberoImpl
 {
     Albero* px;
     Albero* sx;
     Albero* dx;
     int dato;
+
+    // Usato solo dalle funzioni *RB (albero rosso-nero), occupa il padding
+    // del nodo senza aumentarne la dimensione
+    int colore;
+
+#if ALBERO_AUMENTATO
+    int dimensione; // Nodi nel sottoalbero, compreso questo
+    int altezza;    // Altezza del sottoalbero (0 per una foglia)
+#endif
 };
 
+// Ricalcola dimensione ed altezza di mA dai suoi figli
+void albero_impl_aggiorna(Albero* mA)
+{
+#if ALBERO_AUMENTATO
+    int hSx = mA->sx != NULL ? mA->sx->altezza : -1;
+    int hDx = mA->dx != NULL ? mA->dx->altezza : -1;
+
+    mA->dimensione = 1 + (mA->sx != NULL ? mA->sx->dimensione : 0) +
+                     (mA->dx != NULL ? mA->dx->dimensione : 0);
+    mA->altezza = 1 + (hSx > hDx ? hSx : hDx);
+#else
+    (void)mA;
+#endif
+}
+
+// Ricalcola dimensione ed altezza di mA e di tutti i suoi antenati
+// Va chiamata dopo aver collegato o scollegato nodi senza le funzioni
+// albero_* (ad esempio con albero_CreaFiglio)
+void albero_AggiornaRisalendo(Albero* mA)
+{
+#if ALBERO_AUMENTATO
+    for(; mA != NULL; mA = mA->px) albero_impl_aggiorna(mA);
+#else
+    (void)mA;
+#endif
+}
+
 // Alloca memoria per un nodo, lo crea ed inizializza
 // Restituisce 1 in caso di errore
 // Il puntatore passato conterrà l'indirizzo del nodo creato
@@ -25,6 +95,8 @@ int albero_Crea(Albero** mA, int mDato)
 
     (*mA)->px = (*mA)->sx = (*mA)->dx = NULL;
     (*mA)->dato = mDato;
+    (*mA)->colore = ALBERO_ROSSO;
+    albero_impl_aggiorna(*mA);
 
     return 0;
 }
@@ -63,6 +135,48 @@ void albero_Distruggi_Ricorsivo(Albero** mA)
     albero_Distruggi(mA);
 }
 
+// Dealloca iterativamente memoria per un albero, settando il puntatore
+// a NULL
+// Non usa né ricorsione né memoria aggiuntiva: scende fino ad una foglia,
+// la dealloca e risale al padre tramite px, quindi funziona anche su alberi
+// degeneri molto profondi
+void albero_Distruggi_Iterativo(Albero** mA)
+{
+    Albero* a = *mA;
+    Albero* limite;
+
+    if(a == NULL) return;
+
+    limite = a->px;
+
+    while(a != limite)
+    {
+        Albero* padre;
+
+        if(a->sx != NULL)
+            a = a->sx;
+        else if(a->dx != NULL)
+            a = a->dx;
+        else
+        {
+            padre = a->px;
+
+            if(padre != limite)
+            {
+                if(padre->sx == a)
+                    padre->sx = NULL;
+                else
+                    padre->dx = NULL;
+            }
+
+            albero_Distruggi(&a);
+            a = padre;
+        }
+    }
+
+    *mA = NULL;
+}
+
 // Inserisce un nodo in maniera ordinata in un albero
 // Restituisce 1 in caso di errore
 int albero_Inserisci(Albero* mRadice, int mDato)
@@ -78,12 +192,16 @@ int albero_Inserisci(Albero* mRadice, int mDato)
     while(*p != NULL)
     {
         prec = *p;
+        VL_OPS_VISIT();
 
-        if(prec->dato == mDato) return 1;
-        p = mDato < prec->dato ? &prec->sx : &prec->dx;
+        if(VL_OPS_CMP(prec->dato == mDato)) return 1;
+        p = VL_OPS_CMP(mDato < prec->dato) ? &prec->sx : &prec->dx;
     }
 
-    return albero_CreaFiglio(p, prec, mDato);
+    if(albero_CreaFiglio(p, prec, mDato) != 0) return 1;
+
+    albero_AggiornaRisalendo(prec);
+    return 0;
 }
 
 // Versione ricorsiva della funzione di sopra
@@ -96,25 +214,33 @@ int albero_Inserisci_Ricorsivo(Albero* mRadice, int mDato)
     if(mDato == mRadice->dato) return 1;
     if(mDato > mRadice->dato) p = &mRadice->dx;
 
-    if(*p == NULL) return albero_CreaFiglio(p, mRadice, mDato);
+    if(*p == NULL)
+    {
+        if(albero_CreaFiglio(p, mRadice, mDato) != 0) return 1;
+
+        albero_AggiornaRisalendo(mRadice);
+        return 0;
+    }
+
     return albero_Inserisci_Ricorsivo(*p, mDato);
 }
 
 // Cerca un nodo di dato mDato, se lo trova restituisce un
 // puntatore ad esso, altrimenti restituisce NULL
+// Versione iterativa: la profondità dell'albero non è limitata dallo stack
 Albero* albero_Ricerca(Albero* mA, int mDato)
 {
-    assert(mA != NULL);
+    while(mA != NULL && (VL_OPS_VISIT(), VL_OPS_CMP(mDato != mA->dato)))
+        mA = VL_OPS_CMP(mDato < mA->dato) ? mA->sx : mA->dx;
 
-    if(mA == NULL || mDato == mA->dato) return mA;
-    return albero_Ricerca(mDato < mA->dato ? mA->sx : mA->dx, mDato);
+    return mA;
 }
 
 // Scende continuamente a sinistra, restituendo il puntatore al
 // nodo di valore minimo o NULL
 Albero* albero_getMinimo(Albero* mA)
 {
-    while(mA->sx != NULL) mA = mA->sx;
+    while((VL_OPS_VISIT(), mA->sx != NULL)) mA = mA->sx;
     return mA;
 }
 
@@ -122,7 +248,7 @@ Albero* albero_getMinimo(Albero* mA)
 // nodo di valore massimo o NULL
 Albero* albero_getMassimo(Albero* mA)
 {
-    while(mA->dx != NULL) mA = mA->dx;
+    while((VL_OPS_VISIT(), mA->dx != NULL)) mA = mA->dx;
     return mA;
 }
 
@@ -158,7 +284,8 @@ Albero* albero_getSuccPred(Albero* mA, FPAl mFnMinMax, FPAl mFnF1, FPAl mFnF2)
     // Altrimenti risale l'albero finchè non trova un nodo
     // che è il figlio F2 di suo padre - se non esiste
     // restituisce NULL
-    while(mA->px != NULL && mA != (*mFnF2)(mA->px)) mA = mA->px;
+    while(mA->px != NULL && (VL_OPS_VISIT(), mA != (*mFnF2)(mA->px)))
+        mA = mA->px;
     return mA->px;
 }
 
@@ -198,6 +325,9 @@ void albero_Rimuovi(Albero* mA)
             *figlioPadre = mA->sx;
         else if(mA->sx == NULL && mA->dx != NULL)
             *figlioPadre = mA->dx;
+
+        // Il figlio che prende il posto di mA ha un nuovo padre
+        if(*figlioPadre != NULL) (*figlioPadre)->px = padre;
     }
 
     // Altrimenti, se il padre non esiste (cioè mA è la radice), oppure
@@ -219,122 +349,1808 @@ void albero_Rimuovi(Albero* mA)
 
     // Deallochiamo la memoria per il nodo cancellato
     albero_Distruggi(&mA);
+    albero_AggiornaRisalendo(padre);
 }
 
 // Restituisce l'altezza di un albero
+// Con ALBERO_AUMENTATO è memorizzata nella radice, altrimenti viene
+// calcolata con una visita iterativa tramite i puntatori px: per ogni nodo
+// si sa da dove si arriva (dal padre, dal figlio sx o dal figlio dx) e
+// quindi dove andare dopo, senza stack
 int albero_getAltezza(Albero* mRadice)
 {
+#if ALBERO_AUMENTATO
+    return mRadice != NULL ? mRadice->altezza : -1;
+#else
+    Albero* a = mRadice;
+    Albero* prec;
+    int profondita = 0, risultato = -1;
+
     // Se l'albero è vuoto (senza radice), restituisce -1
     if(mRadice == NULL) return -1;
 
-    // Altrimenti restituisce l'altezza maggiore tra il sottoalbero
-    // sx o dx, calcolandola ricorsivamente
-    int hSx = albero_getAltezza(mRadice->sx);
-    int hDx = albero_getAltezza(mRadice->dx);
-    return hSx > hDx ? hSx + 1 : hDx + 1;
+    prec = mRadice->px;
+
+    while(1)
+    {
+        Albero* prossimo = NULL;
+
+        if(prec == a->px)
+        {
+            // Arrivati dal padre: si scende a sx, altrimenti a dx
+            if(profondita > risultato) risultato = profondita;
+            prossimo = a->sx != NULL ? a->sx : a->dx;
+        }
+        else if(prec == a->sx)
+        {
+            // Arrivati dal figlio sx: si scende a dx
+            prossimo = a->dx;
+        }
+
+        prec = a;
+
+        if(prossimo != NULL)
+        {
+            a = prossimo;
+            ++profondita;
+        }
+        else
+        {
+            // Sottoalbero completato: si risale
+            if(a == mRadice) break;
+
+            a = a->px;
+            --profondita;
+        }
+    }
+
+    return risultato;
+#endif
 }
 
-void stampaX(int mSpazi, const char* mStr)
+// Iteratore in ordine crescente
+// Usa solo i puntatori px (nessuno stack): ogni arco viene percorso al più
+// due volte, quindi una visita completa è O(n)
+typedef struct
+{
+    Albero* nodo; // Prossimo nodo da restituire, NULL alla fine
+} AlberoIteratore;
+
+// Posiziona l'iteratore sul nodo minimo dell'albero di radice mRadice
+void albero_IteratoreInizia(AlberoIteratore* mI, Albero* mRadice)
 {
-    for(; mSpazi >= 0; --mSpazi) printf("%s", mStr);
+    mI->nodo = mRadice != NULL ? albero_getMinimo(mRadice) : NULL;
 }
 
-int contaCifre(int mNumero)
+// Posiziona l'iteratore sul primo nodo di dato maggiore o uguale a mDato
+void albero_IteratoreCerca(AlberoIteratore* mI, Albero* mRadice, int mDato)
 {
-    int risultato = 1;
+    mI->nodo = NULL;
+
+    while(mRadice != NULL)
+    {
+        VL_OPS_VISIT();
+
+        if(VL_OPS_CMP(mRadice->dato == mDato))
+        {
+            mI->nodo = mRadice;
+            return;
+        }
+
+        if(VL_OPS_CMP(mDato < mRadice->dato))
+        {
+            mI->nodo = mRadice;
+            mRadice = mRadice->sx;
+        }
+        else
+            mRadice = mRadice->dx;
+    }
+}
+
+// Restituisce il nodo corrente e fa avanzare l'iteratore, oppure
+// restituisce NULL se la visita è terminata
+// mRadice degli albero_Iteratore* deve essere la radice dell'intero albero
+Albero* albero_IteratoreProssimo(AlberoIteratore* mI)
+{
+    Albero* risultato = mI->nodo;
+    Albero* a = risultato;
+
+    if(a == NULL) return NULL;
+
+    if(a->dx != NULL)
+    {
+        a = a->dx;
+        while(a->sx != NULL) a = a->sx;
+    }
+    else
+    {
+        while(a->px != NULL && a == a->px->dx) a = a->px;
+        a = a->px;
+    }
 
-    while(mNumero >= 10)
+    mI->nodo = a;
+    return risultato;
+}
+
+typedef void (*FPAlVisita)(Albero*, void*);
+
+// Visita in ordine crescente i nodi di dato compreso tra mMin e mMax
+// (inclusi), chiamando mFnVisita(nodo, mDati) per ciascuno
+// Restituisce il numero di nodi visitati
+// Costo: O(altezza + nodi visitati)
+size_t albero_RangeQuery(Albero* mRadice, int mMin, int mMax,
+    FPAlVisita mFnVisita, void* mDati)
+{
+    AlberoIteratore it;
+    Albero* a;
+    size_t risultato = 0;
+
+    albero_IteratoreCerca(&it, mRadice, mMin);
+
+    while((a = albero_IteratoreProssimo(&it)) != NULL && a->dato <= mMax)
     {
-        mNumero %= 10;
+        (*mFnVisita)(a, mDati);
         ++risultato;
     }
 
     return risultato;
 }
 
-void albero_AttraversaLiv(Albero* mRadice)
+#if ALBERO_AUMENTATO
+// Restituisce il numero di nodi di dato minore di mDato (o minore o uguale,
+// se mUguali), in O(altezza)
+size_t albero_impl_contaMinori(Albero* mRadice, int mDato, int mUguali)
+{
+    size_t risultato = 0;
+
+    while(mRadice != NULL)
+    {
+        VL_OPS_VISIT();
+
+        if(VL_OPS_CMP(mRadice->dato < mDato) ||
+            (mUguali && VL_OPS_CMP(mRadice->dato == mDato)))
+        {
+            // mRadice ed il suo sottoalbero sx sono tutti minori
+            risultato += 1;
+            if(mRadice->sx != NULL) risultato += mRadice->sx->dimensione;
+            mRadice = mRadice->dx;
+        }
+        else
+            mRadice = mRadice->sx;
+    }
+
+    return risultato;
+}
+
+// Restituisce il numero di nodi di dato minore di mDato
+size_t albero_CountLess(Albero* mRadice, int mDato)
+{
+    return albero_impl_contaMinori(mRadice, mDato, 0);
+}
+
+// Restituisce la posizione di mA nell'ordine crescente dell'albero a cui
+// appartiene (0 per il minimo), risalendo tramite px
+size_t albero_Rank(Albero* mA)
+{
+    size_t risultato = mA->sx != NULL ? mA->sx->dimensione : 0;
+
+    for(; mA->px != NULL; mA = mA->px)
+        if(mA == mA->px->dx)
+            risultato += 1 + (mA->px->sx != NULL ? mA->px->sx->dimensione : 0);
+
+    return risultato;
+}
+
+// Restituisce il nodo in posizione mK nell'ordine crescente (0 per il
+// minimo), oppure NULL se l'albero ha al più mK nodi
+Albero* albero_Select(Albero* mRadice, size_t mK)
+{
+    while(mRadice != NULL)
+    {
+        size_t sx = mRadice->sx != NULL ? mRadice->sx->dimensione : 0;
+        VL_OPS_VISIT();
+
+        if(mK == sx) return mRadice;
+
+        if(mK < sx)
+            mRadice = mRadice->sx;
+        else
+        {
+            mK -= sx + 1;
+            mRadice = mRadice->dx;
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+// Restituisce il numero di nodi di dato compreso tra mMin e mMax (inclusi)
+// Con ALBERO_AUMENTATO costa O(altezza), altrimenti O(altezza + risultato)
+size_t albero_CountRange(Albero* mRadice, int mMin, int mMax)
+{
+#if ALBERO_AUMENTATO
+    if(mMin > mMax) return 0;
+
+    return albero_impl_contaMinori(mRadice, mMax, 1) -
+           albero_impl_contaMinori(mRadice, mMin, 0);
+#else
+    AlberoIteratore it;
+    Albero* a;
+    size_t risultato = 0;
+
+    albero_IteratoreCerca(&it, mRadice, mMin);
+
+    while((a = albero_IteratoreProssimo(&it)) != NULL && a->dato <= mMax)
+        ++risultato;
+
+    return risultato;
+#endif
+}
+
+// Albero rosso-nero
+// Le funzioni *RB mantengono bilanciato l'albero (altezza al più
+// 2 * log2(n + 1)), quindi inserimento, rimozione e ricerca sono O(log n)
+// anche con dati inseriti in ordine. Tutte le funzioni sono iterative.
+// La radice può cambiare in seguito alle rotazioni: per questo ricevono
+// l'indirizzo del puntatore alla radice.
+// I puntatori px ed i nodi restano quelli di un normale albero binario di
+// ricerca, quindi albero_getSuccessore, albero_getPredecessore, ecc.
+// continuano a funzionare.
+
+int albero_isNero(Albero* mA)
+{
+    return mA == NULL || mA->colore == ALBERO_NERO;
+}
+
+// Sostituisce, nel padre di mA (o nella radice), mA con mB
+void albero_Trapianta(Albero** mRadice, Albero* mA, Albero* mB)
+{
+    if(mA->px == NULL)
+        *mRadice = mB;
+    else if(mA == mA->px->sx)
+        mA->px->sx = mB;
+    else
+        mA->px->dx = mB;
+
+    if(mB != NULL) mB->px = mA->px;
+}
+
+// Ruota a sinistra il sottoalbero di radice mA: il figlio dx di mA prende
+// il suo posto, mA diventa il suo figlio sx
+void albero_RuotaSx(Albero** mRadice, Albero* mA)
+{
+    Albero* figlio = mA->dx;
+    assert(figlio != NULL);
+    VL_OPS_MOVE(1);
+
+    mA->dx = figlio->sx;
+    if(figlio->sx != NULL) figlio->sx->px = mA;
+
+    albero_Trapianta(mRadice, mA, figlio);
+
+    figlio->sx = mA;
+    mA->px = figlio;
+
+    // I sottoalberi degli antenati contengono gli stessi nodi, ma la loro
+    // altezza può cambiare: vanno aggiornati dal chiamante
+    albero_impl_aggiorna(mA);
+    albero_impl_aggiorna(figlio);
+}
+
+// Ruota a destra il sottoalbero di radice mA: il figlio sx di mA prende
+// il suo posto, mA diventa il suo figlio dx
+void albero_RuotaDx(Albero** mRadice, Albero* mA)
 {
-    Albero* coda[100];
-    int i, spazi = 44, precSpazi = 0, passaggi = 0, livello = 0;
-    for(i = 0; i < 100; ++i) coda[i] = NULL;
+    Albero* figlio = mA->sx;
+    assert(figlio != NULL);
+    VL_OPS_MOVE(1);
 
-    coda[0] = mRadice;
+    mA->sx = figlio->dx;
+    if(figlio->dx != NULL) figlio->dx->px = mA;
 
-    for(i = 0; i < 20; ++i)
+    albero_Trapianta(mRadice, mA, figlio);
+
+    figlio->dx = mA;
+    mA->px = figlio;
+
+    // I sottoalberi degli antenati contengono gli stessi nodi, ma la loro
+    // altezza può cambiare: vanno aggiornati dal chiamante
+    albero_impl_aggiorna(mA);
+    albero_impl_aggiorna(figlio);
+}
+
+// Inserisce un nodo già allocato in un albero rosso-nero
+// Restituisce 1 se un nodo con lo stesso dato è già presente (in quel caso
+// mNodo non viene collegato e resta di proprietà del chiamante)
+int albero_InserisciNodoRB(Albero** mRadice, Albero* mNodo)
+{
+    Albero* nuovo;
+    Albero* padre = NULL;
+    Albero** p = mRadice;
+
+    // Discesa come in albero_Inserisci
+    while(*p != NULL)
+    {
+        padre = *p;
+        VL_OPS_VISIT();
+
+        if(VL_OPS_CMP(padre->dato == mNodo->dato)) return 1;
+        p = VL_OPS_CMP(mNodo->dato < padre->dato) ? &padre->sx : &padre->dx;
+    }
+
+    *p = mNodo;
+    mNodo->px = padre;
+    mNodo->sx = mNodo->dx = NULL;
+    mNodo->colore = ALBERO_ROSSO;
+
+    nuovo = mNodo;
+    albero_AggiornaRisalendo(nuovo);
+
+    // Finchè il nodo rosso ha un padre rosso, risale l'albero ricolorando
+    // (zio rosso) o ruotando (zio nero, al più due rotazioni)
+    while(mNodo->px != NULL && mNodo->px->colore == ALBERO_ROSSO)
     {
-        Albero* c = coda[i];
-        int numSimboli = (passaggi == 0) ? spazi : precSpazi, cifre;
-        const char* simbolo = (passaggi % 2 == 0) ? " " : "-";
+        Albero* nonno;
+        Albero* zio;
+
+        padre = mNodo->px;
+        nonno = padre->px; // Esiste sempre: la radice è nera
 
-        if(c != NULL)
+        if(padre == nonno->sx)
         {
-            cifre = contaCifre(c->dato);
+            zio = nonno->dx;
+
+            if(!albero_isNero(zio))
+            {
+                padre->colore = zio->colore = ALBERO_NERO;
+                nonno->colore = ALBERO_ROSSO;
+                mNodo = nonno;
+                continue;
+            }
+
+            if(mNodo == padre->dx)
+            {
+                albero_RuotaSx(mRadice, padre);
+                padre = mNodo;
+            }
 
-            stampaX(numSimboli - cifre - 4, simbolo);
-            printf("( %d )", c->dato);
+            padre->colore = ALBERO_NERO;
+            nonno->colore = ALBERO_ROSSO;
+            albero_RuotaDx(mRadice, nonno);
 
-            coda[2 * i + 1] = c->sx;
-            coda[2 * i + 2] = c->dx;
+            // Il sottoalbero ruotato ha radice nera: l'albero è valido
+            break;
         }
         else
         {
-            cifre = 1;
+            zio = nonno->sx;
+
+            if(!albero_isNero(zio))
+            {
+                padre->colore = zio->colore = ALBERO_NERO;
+                nonno->colore = ALBERO_ROSSO;
+                mNodo = nonno;
+                continue;
+            }
+
+            if(mNodo == padre->sx)
+            {
+                albero_RuotaDx(mRadice, padre);
+                padre = mNodo;
+            }
 
-            stampaX(numSimboli - cifre, simbolo);
-            printf("X");
+            padre->colore = ALBERO_NERO;
+            nonno->colore = ALBERO_ROSSO;
+            albero_RuotaSx(mRadice, nonno);
+
+            // Il sottoalbero ruotato ha radice nera: l'albero è valido
+            break;
         }
+    }
+
+    (*mRadice)->colore = ALBERO_NERO;
+
+    // Le rotazioni avvengono lungo il percorso dal nuovo nodo alla radice
+    albero_AggiornaRisalendo(nuovo);
+    return 0;
+}
+
+// Crea un nodo di dato mDato e lo inserisce in un albero rosso-nero
+// *mRadice può essere NULL (albero vuoto)
+// Restituisce 1 in caso di errore o se il dato è già presente
+int albero_InserisciRB(Albero** mRadice, int mDato)
+{
+    Albero* nodo;
+
+    if(albero_Crea(&nodo, mDato) != 0) return 1;
+    if(albero_InserisciNodoRB(mRadice, nodo) == 0) return 0;
+
+    albero_Distruggi(&nodo);
+    return 1;
+}
+
+// Ripristina le proprietà rosso-nero dopo la rimozione di un nodo nero
+// mA ha un nero "in più" e può essere NULL, per questo viene passato
+// anche suo padre
+void albero_RiparaRimozioneRB(Albero** mRadice, Albero* mA, Albero* mPadre)
+{
+    Albero* fratello;
+
+    while(mA != *mRadice && albero_isNero(mA))
+    {
+        if(mA == mPadre->sx)
+        {
+            fratello = mPadre->dx;
+
+            if(!albero_isNero(fratello))
+            {
+                fratello->colore = ALBERO_NERO;
+                mPadre->colore = ALBERO_ROSSO;
+                albero_RuotaSx(mRadice, mPadre);
+                fratello = mPadre->dx;
+            }
+
+            if(albero_isNero(fratello->sx) && albero_isNero(fratello->dx))
+            {
+                fratello->colore = ALBERO_ROSSO;
+                mA = mPadre;
+                mPadre = mA->px;
+                continue;
+            }
 
-        if(++passaggi >= pow(2, livello))
+            if(albero_isNero(fratello->dx))
+            {
+                fratello->sx->colore = ALBERO_NERO;
+                fratello->colore = ALBERO_ROSSO;
+                albero_RuotaDx(mRadice, fratello);
+                fratello = mPadre->dx;
+            }
+
+            fratello->colore = mPadre->colore;
+            mPadre->colore = ALBERO_NERO;
+            fratello->dx->colore = ALBERO_NERO;
+            albero_RuotaSx(mRadice, mPadre);
+        }
+        else
         {
-            ++livello;
+            fratello = mPadre->sx;
 
-            printf("\n");
-            stampaX(spazi - 1, " ");
-            printf("|");
+            if(!albero_isNero(fratello))
+            {
+                fratello->colore = ALBERO_NERO;
+                mPadre->colore = ALBERO_ROSSO;
+                albero_RuotaDx(mRadice, mPadre);
+                fratello = mPadre->sx;
+            }
 
-            for(; passaggi > 1; --passaggi)
+            if(albero_isNero(fratello->sx) && albero_isNero(fratello->dx))
             {
-                stampaX(precSpazi - 1, " ");
-                printf("|");
+                fratello->colore = ALBERO_ROSSO;
+                mA = mPadre;
+                mPadre = mA->px;
+                continue;
             }
 
-            printf("\n");
+            if(albero_isNero(fratello->sx))
+            {
+                fratello->dx->colore = ALBERO_NERO;
+                fratello->colore = ALBERO_ROSSO;
+                albero_RuotaSx(mRadice, fratello);
+                fratello = mPadre->sx;
+            }
 
-            precSpazi = spazi;
-            spazi /= 2;
-            passaggi = 0;
+            fratello->colore = mPadre->colore;
+            mPadre->colore = ALBERO_NERO;
+            fratello->sx->colore = ALBERO_NERO;
+            albero_RuotaDx(mRadice, mPadre);
         }
+
+        mA = *mRadice;
     }
+
+    if(mA != NULL) mA->colore = ALBERO_NERO;
 }
 
-int main()
+// Scollega il nodo mA da un albero rosso-nero, senza deallocarlo
+// A differenza di albero_Rimuovi, non copia dati tra i nodi: se mA ha due
+// figli, al suo posto viene spostato il nodo successore
+void albero_StaccaNodoRB(Albero** mRadice, Albero* mA)
 {
-    Albero* a;
+    Albero* sostituto;
+    Albero* figlio;
+    Albero* padreFiglio;
+    int coloreRimosso = mA->colore;
 
-    albero_Crea(&a, 9);
+    assert(mA != NULL);
 
-    albero_Inserisci(a, 5);
-    albero_Inserisci(a, 2);
-    albero_Inserisci(a, 8);
-    albero_Inserisci(a, 12);
-    albero_Inserisci(a, 3);
-    albero_Inserisci(a, 7);
-    albero_Inserisci(a, 10);
-    albero_Inserisci(a, 15);
-    albero_Inserisci(a, 17);
-    albero_Inserisci(a, 4);
-    albero_Inserisci(a, 1);
-    albero_Inserisci(a, 11);
+    if(mA->sx == NULL || mA->dx == NULL)
+    {
+        // Al più un figlio: prende il posto di mA
+        figlio = (mA->sx != NULL) ? mA->sx : mA->dx;
+        padreFiglio = mA->px;
+        albero_Trapianta(mRadice, mA, figlio);
+    }
+    else
+    {
+        // Due figli: il successore (che non ha figlio sx) prende il posto
+        // di mA, ed il suo figlio dx prende il posto del successore
+        sostituto = albero_getMinimo(mA->dx);
+        coloreRimosso = sostituto->colore;
+        figlio = sostituto->dx;
+
+        if(sostituto->px == mA)
+            padreFiglio = sostituto;
+        else
+        {
+            padreFiglio = sostituto->px;
+            albero_Trapianta(mRadice, sostituto, sostituto->dx);
+            sostituto->dx = mA->dx;
+            sostituto->dx->px = sostituto;
+        }
 
-    albero_AttraversaLiv(a);
+        albero_Trapianta(mRadice, mA, sostituto);
+        sostituto->sx = mA->sx;
+        sostituto->sx->px = sostituto;
+        sostituto->colore = mA->colore;
+    }
 
-    printf("\n\n");
-    albero_Rimuovi(albero_Ricerca(a, 5));
-    albero_AttraversaLiv(a);
+    albero_AggiornaRisalendo(padreFiglio);
 
-    printf("\nAltezza: %d", albero_getAltezza(a));
+    if(coloreRimosso == ALBERO_NERO)
+        albero_RiparaRimozioneRB(mRadice, figlio, padreFiglio);
 
-    albero_Distruggi_Ricorsivo(&a);
+    // Le rotazioni avvengono lungo il percorso da padreFiglio alla radice
+    albero_AggiornaRisalendo(padreFiglio);
+
+    mA->px = mA->sx = mA->dx = NULL;
+}
+
+// Rimuove e dealloca il nodo mA da un albero rosso-nero
+void albero_RimuoviRB(Albero** mRadice, Albero* mA)
+{
+    albero_StaccaNodoRB(mRadice, mA);
+    albero_Distruggi(&mA);
+}
+
+// Verifica le proprietà di un albero rosso-nero (ordinamento, puntatori
+// px, nessun nodo rosso con figli rossi, stessa altezza nera su ogni
+// cammino)
+// Restituisce l'altezza nera, oppure -1 se l'albero non è valido
+int albero_VerificaRB(Albero* mA)
+{
+    int hSx, hDx;
+
+    if(mA == NULL) return 0;
+
+    if(mA->sx != NULL && (mA->sx->px != mA || mA->sx->dato >= mA->dato))
+        return -1;
+    if(mA->dx != NULL && (mA->dx->px != mA || mA->dx->dato <= mA->dato))
+        return -1;
+    if(!albero_isNero(mA) &&
+        (!albero_isNero(mA->sx) || !albero_isNero(mA->dx)))
+        return -1;
+
+    hSx = albero_VerificaRB(mA->sx);
+    hDx = albero_VerificaRB(mA->dx);
+
+    if(hSx == -1 || hSx != hDx) return -1;
+    return hSx + albero_isNero(mA);
+}
+
+// Arena di nodi
+// Invece di una malloc per ogni nodo, i nodi vengono presi in ordine da
+// blocchi contigui di ALBERO_ARENA_BLOCCO nodi: la costruzione evita
+// l'allocatore e nodi creati in sequenza restano vicini in memoria.
+// I nodi rilasciati vengono riutilizzati tramite una lista di nodi liberi
+// intrusiva (collegata attraverso il campo sx dei nodi stessi).
+// Tutti i nodi di un albero devono provenire dalla stessa arena:
+// albero_ArenaDistruggi libera l'intero albero in O(blocchi), senza
+// visitarne i nodi.
+
+#define ALBERO_ARENA_BLOCCO 4096
+
+struct AlberoBloccoImpl;
+typedef struct AlberoBloccoImpl AlberoBlocco;
+
+struct AlberoBloccoImpl
+{
+    AlberoBlocco* prossimo;
+    Albero nodi[ALBERO_ARENA_BLOCCO];
+};
+
+typedef struct
+{
+    AlberoBlocco* blocchi; // Il primo è quello in uso
+    size_t usati;          // Nodi già presi dal blocco in uso
+    Albero* liberi;        // Lista dei nodi rilasciati
+} AlberoArena;
+
+void albero_ArenaInizializza(AlberoArena* mArena)
+{
+    mArena->blocchi = NULL;
+    mArena->usati = ALBERO_ARENA_BLOCCO;
+    mArena->liberi = NULL;
+}
+
+// Prende un nodo dall'arena, lo crea ed inizializza come albero_Crea
+// Restituisce 1 in caso di errore
+int albero_ArenaCrea(AlberoArena* mArena, Albero** mA, int mDato)
+{
+    if(mArena->liberi != NULL)
+    {
+        *mA = mArena->liberi;
+        mArena->liberi = mArena->liberi->sx;
+    }
+    else
+    {
+        if(mArena->usati == ALBERO_ARENA_BLOCCO)
+        {
+            AlberoBlocco* blocco = malloc(sizeof(AlberoBlocco));
+            if(blocco == NULL) return 1;
+
+            blocco->prossimo = mArena->blocchi;
+            mArena->blocchi = blocco;
+            mArena->usati = 0;
+        }
+
+        *mA = &mArena->blocchi->nodi[mArena->usati++];
+    }
+
+    (*mA)->px = (*mA)->sx = (*mA)->dx = NULL;
+    (*mA)->dato = mDato;
+    (*mA)->colore = ALBERO_ROSSO;
+    albero_impl_aggiorna(*mA);
+
+    return 0;
+}
+
+// Restituisce un nodo all'arena, in O(1)
+void albero_ArenaRilascia(AlberoArena* mArena, Albero* mA)
+{
+    mA->sx = mArena->liberi;
+    mArena->liberi = mA;
+}
+
+// Libera tutti i nodi dell'arena, in O(blocchi)
+void albero_ArenaDistruggi(AlberoArena* mArena)
+{
+    while(mArena->blocchi != NULL)
+    {
+        AlberoBlocco* prossimo = mArena->blocchi->prossimo;
+        free(mArena->blocchi);
+        mArena->blocchi = prossimo;
+    }
+
+    albero_ArenaInizializza(mArena);
+}
+
+// Come albero_InserisciRB, con il nodo preso dall'arena
+int albero_ArenaInserisciRB(AlberoArena* mArena, Albero** mRadice, int mDato)
+{
+    Albero* nodo;
+
+    if(albero_ArenaCrea(mArena, &nodo, mDato) != 0) return 1;
+    if(albero_InserisciNodoRB(mRadice, nodo) == 0) return 0;
+
+    albero_ArenaRilascia(mArena, nodo);
+    return 1;
+}
+
+// Come albero_RimuoviRB, restituendo il nodo all'arena
+void albero_ArenaRimuoviRB(AlberoArena* mArena, Albero** mRadice, Albero* mA)
+{
+    albero_StaccaNodoRB(mRadice, mA);
+    albero_ArenaRilascia(mArena, mA);
+}
+
+// Costruzione da dati ordinati
+// Collega i nodi mNodi[mInizio, mFine), in ordine crescente, in un albero
+// perfettamente bilanciato: il nodo centrale diventa la radice ed i due
+// sottoalberi vengono costruiti allo stesso modo. Ogni nodo viene visitato
+// una volta, la ricorsione è profonda log2(n).
+// Le foglie sono tutte a profondità mAltezzaMax o mAltezzaMax - 1: colorando
+// di rosso i nodi a profondità mAltezzaMax il risultato è anche un albero
+// rosso-nero valido.
+Albero* albero_impl_collega(Albero** mNodi, size_t mInizio, size_t mFine,
+    Albero* mPadre, int mProfondita, int mAltezzaMax)
+{
+    size_t centro;
+    Albero* nodo;
+
+    if(mInizio == mFine) return NULL;
+
+    centro = mInizio + (mFine - mInizio) / 2;
+    nodo = mNodi[centro];
+
+    nodo->px = mPadre;
+    nodo->colore = mProfondita == mAltezzaMax ? ALBERO_ROSSO : ALBERO_NERO;
+    nodo->sx = albero_impl_collega(
+        mNodi, mInizio, centro, nodo, mProfondita + 1, mAltezzaMax);
+    nodo->dx = albero_impl_collega(
+        mNodi, centro + 1, mFine, nodo, mProfondita + 1, mAltezzaMax);
+    albero_impl_aggiorna(nodo);
+
+    return nodo;
+}
+
+// Collega mNumero nodi ordinati in un albero bilanciato e ne restituisce
+// la radice
+// La radice è sempre nera: con un solo nodo altezzaMax vale 0 e
+// albero_impl_collega la colorerebbe di rosso
+Albero* albero_impl_collegaTutti(Albero** mNodi, size_t mNumero)
+{
+    Albero* radice;
+    int altezzaMax = 0;
+
+    while(((size_t)2 << altezzaMax) <= mNumero) ++altezzaMax;
+    radice = albero_impl_collega(mNodi, 0, mNumero, NULL, 0, altezzaMax);
+    if(radice != NULL) radice->colore = ALBERO_NERO;
+
+    return radice;
+}
+
+// Crea un nodo con albero_Crea, oppure dall'arena se mArena non è NULL
+int albero_impl_creaDa(AlberoArena* mArena, Albero** mA, int mDato)
+{
+    return mArena != NULL ? albero_ArenaCrea(mArena, mA, mDato)
+                          : albero_Crea(mA, mDato);
+}
+
+void albero_impl_rilasciaDa(AlberoArena* mArena, Albero* mA)
+{
+    if(mArena != NULL)
+        albero_ArenaRilascia(mArena, mA);
+    else
+        albero_Distruggi(&mA);
+}
+
+Albero* albero_impl_costruisciDaOrdinato(
+    AlberoArena* mArena, const int* mDati, size_t mNumero)
+{
+    Albero** nodi;
+    Albero* radice;
+    size_t i;
+
+    if(mNumero == 0) return NULL;
+
+    nodi = malloc(mNumero * sizeof(Albero*));
+    if(nodi == NULL) return NULL;
+
+    for(i = 0; i < mNumero; ++i)
+    {
+        assert(i == 0 || mDati[i - 1] < mDati[i]);
+
+        if(albero_impl_creaDa(mArena, &nodi[i], mDati[i]) != 0)
+        {
+            while(i > 0) albero_impl_rilasciaDa(mArena, nodi[--i]);
+            free(nodi);
+            return NULL;
+        }
+    }
+
+    radice = albero_impl_collegaTutti(nodi, mNumero);
+
+    free(nodi);
+    return radice;
+}
+
+// Costruisce in O(n) un albero perfettamente bilanciato (ed un albero
+// rosso-nero valido) dagli mNumero dati di mDati, strettamente crescenti
+// Restituisce la radice, oppure NULL in caso di errore o se mNumero è 0
+Albero* albero_CostruisciDaOrdinato(const int* mDati, size_t mNumero)
+{
+    return albero_impl_costruisciDaOrdinato(NULL, mDati, mNumero);
+}
+
+// Come albero_CostruisciDaOrdinato, con i nodi presi dall'arena
+Albero* albero_ArenaCostruisciDaOrdinato(
+    AlberoArena* mArena, const int* mDati, size_t mNumero)
+{
+    return albero_impl_costruisciDaOrdinato(mArena, mDati, mNumero);
+}
+
+int albero_impl_confrontaInt(const void* mA, const void* mB)
+{
+    int a = *(const int*)mA, b = *(const int*)mB;
+    return (a > b) - (a < b);
+}
+
+// Restituisce il numero di nodi, visitandoli con i puntatori px
+size_t albero_impl_contaNodi(Albero* mA)
+{
+    size_t risultato = 0;
+
+    if(mA == NULL) return 0;
+
+    for(mA = albero_getMinimo(mA); mA != NULL; mA = albero_getSuccessore(mA))
+        ++risultato;
+
+    return risultato;
+}
+
+int albero_impl_inserisciBatch(
+    AlberoArena* mArena, Albero** mRadice, const int* mDati, size_t mNumero)
+{
+    int* ordinati;
+    Albero** nodi;
+    Albero* a;
+    size_t i, j, unici, esistenti, totale, logEsistenti = 0;
+
+    if(mNumero == 0) return 0;
+
+    ordinati = malloc(mNumero * sizeof(int));
+    if(ordinati == NULL) return 1;
+
+    for(i = 0; i < mNumero; ++i) ordinati[i] = mDati[i];
+    qsort(ordinati, mNumero, sizeof(int), &albero_impl_confrontaInt);
+
+    for(i = 1, unici = 1; i < mNumero; ++i)
+        if(ordinati[i] != ordinati[unici - 1]) ordinati[unici++] = ordinati[i];
+
+    esistenti = albero_impl_contaNodi(*mRadice);
+    while(((size_t)1 << logEsistenti) < esistenti) ++logEsistenti;
+
+    // Pochi dati rispetto all'albero: inserimenti singoli, in ordine per
+    // riutilizzare i nodi già in cache lungo i percorsi
+    if(unici * logEsistenti < esistenti)
+    {
+        for(i = 0; i < unici; ++i)
+        {
+            Albero* nodo;
+
+            if(albero_impl_creaDa(mArena, &nodo, ordinati[i]) != 0)
+            {
+                free(ordinati);
+                return 1;
+            }
+
+            if(albero_InserisciNodoRB(mRadice, nodo) != 0)
+                albero_impl_rilasciaDa(mArena, nodo);
+        }
+
+        free(ordinati);
+        return 0;
+    }
+
+    // Altrimenti, unione dei nodi esistenti (visitati in ordine) con i
+    // nuovi dati, e ricostruzione dell'albero: O(n + m log m)
+    totale = esistenti + unici;
+    nodi = malloc(totale * sizeof(Albero*));
+
+    if(nodi == NULL)
+    {
+        free(ordinati);
+        return 1;
+    }
+
+    a = *mRadice != NULL ? albero_getMinimo(*mRadice) : NULL;
+
+    for(j = totale = 0; a != NULL || j < unici;)
+    {
+        if(a != NULL && (j == unici || a->dato <= ordinati[j]))
+        {
+            if(j < unici && a->dato == ordinati[j]) ++j;
+
+            nodi[totale++] = a;
+            a = albero_getSuccessore(a);
+            continue;
+        }
+
+        if(albero_impl_creaDa(mArena, &nodi[totale], ordinati[j++]) != 0)
+        {
+            // L'albero esistente non è ancora stato modificato: basta
+            // rilasciare i nodi nuovi, gli unici senza padre oltre alla
+            // radice
+            for(i = 0; i < totale; ++i)
+                if(nodi[i]->px == NULL && nodi[i] != *mRadice)
+                    albero_impl_rilasciaDa(mArena, nodi[i]);
+
+            free(nodi);
+            free(ordinati);
+            return 1;
+        }
+
+        ++totale;
+    }
+
+    *mRadice = albero_impl_collegaTutti(nodi, totale);
+
+    free(nodi);
+    free(ordinati);
+    return 0;
+}
+
+// Inserisce in un albero rosso-nero gli mNumero dati di mDati, in qualsiasi
+// ordine (i dati già presenti vengono ignorati)
+// Se il lotto è grande rispetto all'albero, i dati vengono ordinati ed
+// uniti ai nodi esistenti, che vengono ricollegati in un albero bilanciato
+// Restituisce 1 in caso di errore
+int albero_InserisciBatch(Albero** mRadice, const int* mDati, size_t mNumero)
+{
+    return albero_impl_inserisciBatch(NULL, mRadice, mDati, mNumero);
+}
+
+// Come albero_InserisciBatch, con i nodi presi dall'arena
+int albero_ArenaInserisciBatch(AlberoArena* mArena, Albero** mRadice,
+    const int* mDati, size_t mNumero)
+{
+    return albero_impl_inserisciBatch(mArena, mRadice, mDati, mNumero);
+}
+
+// Visita per livelli
+// La coda è un buffer circolare di capacità potenza di 2, raddoppiata
+// quando è piena: la memoria usata è proporzionale al livello più largo e
+// non c'è limite alla profondità dell'albero.
+
+typedef struct
+{
+    Albero** elementi;
+    size_t capacita; // Sempre potenza di 2
+    size_t testa;
+    size_t numero;
+} AlberoCoda;
+
+// Restituisce 1 in caso di errore
+int albero_CodaInizializza(AlberoCoda* mC, size_t mCapacita)
+{
+    size_t capacita = 1;
+    while(capacita < mCapacita) capacita *= 2;
+
+    mC->elementi = malloc(capacita * sizeof(Albero*));
+    mC->capacita = capacita;
+    mC->testa = mC->numero = 0;
+
+    return mC->elementi == NULL;
+}
+
+void albero_CodaDistruggi(AlberoCoda* mC)
+{
+    free(mC->elementi);
+    mC->elementi = NULL;
+}
+
+// Restituisce 1 in caso di errore
+int albero_CodaInserisci(AlberoCoda* mC, Albero* mA)
+{
+    if(mC->numero == mC->capacita)
+    {
+        // Raddoppia, spostando gli elementi in ordine all'inizio del nuovo
+        // buffer
+        Albero** elementi = malloc(2 * mC->capacita * sizeof(Albero*));
+        size_t i;
+
+        if(elementi == NULL) return 1;
+
+        for(i = 0; i < mC->numero; ++i)
+            elementi[i] = mC->elementi[(mC->testa + i) & (mC->capacita - 1)];
+
+        free(mC->elementi);
+        mC->elementi = elementi;
+        mC->capacita *= 2;
+        mC->testa = 0;
+    }
+
+    mC->elementi[(mC->testa + mC->numero++) & (mC->capacita - 1)] = mA;
+    return 0;
+}
+
+Albero* albero_CodaEstrai(AlberoCoda* mC)
+{
+    Albero* risultato = mC->elementi[mC->testa];
+
+    assert(mC->numero > 0);
+
+    mC->testa = (mC->testa + 1) & (mC->capacita - 1);
+    --mC->numero;
+
+    return risultato;
+}
+
+typedef void (*FPAlLivello)(int, size_t, void*);
+
+// Visita l'albero per livelli, da sinistra a destra
+// All'inizio di ogni livello chiama mFnLivello(livello, nodi nel livello,
+// mDati), poi mFnNodo(nodo, mDati) per ogni nodo del livello (entrambe
+// possono essere NULL)
+// Restituisce 1 in caso di errore
+int albero_AttraversaLivelli(Albero* mRadice, FPAlVisita mFnNodo,
+    FPAlLivello mFnLivello, void* mDati)
+{
+    AlberoCoda coda;
+    int livello;
+
+    if(mRadice == NULL) return 0;
+    if(albero_CodaInizializza(&coda, 64) != 0) return 1;
+
+    albero_CodaInserisci(&coda, mRadice);
+
+    for(livello = 0; coda.numero > 0; ++livello)
+    {
+        // I nodi in coda sono esattamente quelli del livello corrente
+        size_t i, numero = coda.numero;
+
+        if(mFnLivello != NULL) (*mFnLivello)(livello, numero, mDati);
+
+        for(i = 0; i < numero; ++i)
+        {
+            Albero* a = albero_CodaEstrai(&coda);
+
+            if(mFnNodo != NULL) (*mFnNodo)(a, mDati);
+
+            if((a->sx != NULL && albero_CodaInserisci(&coda, a->sx) != 0) ||
+                (a->dx != NULL && albero_CodaInserisci(&coda, a->dx) != 0))
+            {
+                albero_CodaDistruggi(&coda);
+                return 1;
+            }
+        }
+    }
+
+    albero_CodaDistruggi(&coda);
+    return 0;
+}
+
+// Scrittura bufferizzata di righe di larghezza limitata
+// Il testo oltre mLarghezza colonne viene scartato senza essere formattato,
+// e la riga termina con "..."; il file viene scritto a blocchi di
+// ALBERO_BUFFER byte.
+
+#define ALBERO_BUFFER 4096
+
+typedef struct
+{
+    FILE* file;
+    char buffer[ALBERO_BUFFER];
+    size_t usati;
+    size_t colonna;
+    size_t larghezza;
+    int troncata;
+} AlberoScrittore;
+
+void albero_ScrittoreInizializza(
+    AlberoScrittore* mS, FILE* mFile, size_t mLarghezza)
+{
+    assert(mLarghezza > 3);
+
+    mS->file = mFile;
+    mS->usati = mS->colonna = 0;
+    mS->larghezza = mLarghezza;
+    mS->troncata = 0;
+}
+
+void albero_ScrittoreSvuota(AlberoScrittore* mS)
+{
+    fwrite(mS->buffer, 1, mS->usati, mS->file);
+    mS->usati = 0;
+}
+
+void albero_impl_scriviBuffer(
+    AlberoScrittore* mS, const char* mStr, size_t mLunghezza)
+{
+    if(mS->usati + mLunghezza > ALBERO_BUFFER) albero_ScrittoreSvuota(mS);
+
+    memcpy(mS->buffer + mS->usati, mStr, mLunghezza);
+    mS->usati += mLunghezza;
+}
+
+// Restituisce 1 se la riga corrente è già stata troncata (ed il testo
+// successivo verrebbe scartato)
+int albero_ScrittoreTroncata(const AlberoScrittore* mS) { return mS->troncata; }
+
+void albero_ScrittoreScrivi(AlberoScrittore* mS, const char* mStr)
+{
+    size_t lunghezza = strlen(mStr);
+
+    if(mS->troncata) return;
+
+    // Lascia sempre spazio per "..."
+    if(mS->colonna + lunghezza > mS->larghezza - 3)
+    {
+        albero_impl_scriviBuffer(mS, "...", 3);
+        mS->troncata = 1;
+        return;
+    }
+
+    albero_impl_scriviBuffer(mS, mStr, lunghezza);
+    mS->colonna += lunghezza;
+}
+
+void albero_ScrittoreACapo(AlberoScrittore* mS)
+{
+    albero_impl_scriviBuffer(mS, "\n", 1);
+    mS->colonna = 0;
+    mS->troncata = 0;
+}
+
+// Visualizzazione per livelli: ogni livello è una riga, ogni nodo è
+// preceduto da '/' se è figlio sx e da '\\' se è figlio dx
+void albero_impl_disegnaLivello(int mLivello, size_t mNumero, void* mS)
+{
+    char testo[64];
+
+    if(mLivello > 0) albero_ScrittoreACapo(mS);
+
+    sprintf(testo, "%3d (%lu):", mLivello, (unsigned long)mNumero);
+    albero_ScrittoreScrivi(mS, testo);
+}
+
+void albero_impl_disegnaNodo(Albero* mA, void* mS)
+{
+    char testo[16];
+
+    if(albero_ScrittoreTroncata(mS)) return;
+
+    sprintf(testo, " %s%d",
+        mA->px == NULL ? "" : (mA == mA->px->sx ? "/" : "\\"), mA->dato);
+    albero_ScrittoreScrivi(mS, testo);
+}
+
+// Scrive l'albero per livelli in mFile, con righe di al più mLarghezza
+// caratteri
+// Restituisce 1 in caso di errore
+int albero_Disegna(Albero* mRadice, FILE* mFile, size_t mLarghezza)
+{
+    AlberoScrittore s;
+    int risultato;
+
+    albero_ScrittoreInizializza(&s, mFile, mLarghezza);
+
+    risultato = albero_AttraversaLivelli(mRadice, &albero_impl_disegnaNodo,
+        &albero_impl_disegnaLivello, &s);
+
+    albero_ScrittoreACapo(&s);
+    albero_ScrittoreSvuota(&s);
+
+    return risultato;
+}
+
+void albero_AttraversaLiv(Albero* mRadice)
+{
+    albero_Disegna(mRadice, stdout, 80);
+}
+
+// Snapshot su file
+// L'albero viene salvato come intestazione seguita dai dati, senza
+// puntatori, in ordine crescente oppure nell'ordine di Eytzinger (l'albero
+// perfettamente bilanciato memorizzato per livelli, come un heap: i figli
+// dell'elemento k, contando da 1, sono 2k e 2k + 1). Il file viene mappato
+// in memoria con mmap ed interrogato direttamente, senza ricostruire
+// l'albero: l'apertura costa O(1) se non si verifica il checksum.
+// I dati sono scritti nell'ordine dei byte della macchina che li salva.
+
+#define ALBERO_SNAPSHOT_ORDINATO 0
+#define ALBERO_SNAPSHOT_EYTZINGER 1
+#define ALBERO_SNAPSHOT_VERSIONE 1
+
+typedef struct
+{
+    char magia[8]; // "ALBEROSN"
+    unsigned int versione;
+    unsigned int ordine;
+    unsigned long long numero;
+    unsigned long long checksum;
+} AlberoSnapshotTesta;
+
+typedef struct
+{
+    void* mappa;
+    size_t dimensioneMappa;
+    const int* dati;
+    size_t numero;
+    unsigned int ordine;
+} AlberoSnapshot;
+
+// Checksum di Fletcher su parole di 32 bit
+unsigned long long albero_impl_checksum(const int* mDati, size_t mNumero)
+{
+    unsigned long long a = 0, b = 0;
+    size_t i;
+
+    for(i = 0; i < mNumero; ++i)
+    {
+        a += (unsigned int)mDati[i];
+        b += a;
+    }
+
+    return (b << 32) ^ a;
+}
+
+// Posizione (da 1) del primo elemento nell'ordine di Eytzinger
+size_t albero_impl_eytzingerPrimo(size_t mNumero)
+{
+    size_t k = 1;
+
+    if(mNumero == 0) return 0;
+    while(2 * k <= mNumero) k *= 2;
+
+    return k;
+}
+
+// Posizione (da 1) dell'elemento successivo a k nell'ordine di Eytzinger,
+// oppure 0 se k è l'ultimo
+size_t albero_impl_eytzingerSuccessivo(size_t mK, size_t mNumero)
+{
+    if(2 * mK + 1 <= mNumero)
+    {
+        // Il minimo del sottoalbero dx
+        mK = 2 * mK + 1;
+        while(2 * mK <= mNumero) mK *= 2;
+        return mK;
+    }
+
+    // Risale finchè k è un figlio dx, poi ancora di un livello
+    while(mK & 1) mK >>= 1;
+    return mK >> 1;
+}
+
+// Salva l'albero nel file mPercorso, con mOrdine ALBERO_SNAPSHOT_ORDINATO o
+// ALBERO_SNAPSHOT_EYTZINGER
+// Restituisce 1 in caso di errore
+int albero_SalvaSnapshot(Albero* mRadice, const char* mPercorso, int mOrdine)
+{
+    AlberoSnapshotTesta testa;
+    AlberoIteratore it;
+    Albero* a;
+    FILE* file;
+    int* dati = NULL;
+    int* ordinati;
+    size_t i, numero = 0, k;
+    int risultato = 1;
+
+    for(albero_IteratoreInizia(&it, mRadice); albero_IteratoreProssimo(&it);)
+        ++numero;
+
+    ordinati = malloc((numero > 0 ? numero : 1) * sizeof(int));
+    if(ordinati == NULL) return 1;
+
+    albero_IteratoreInizia(&it, mRadice);
+    for(i = 0; (a = albero_IteratoreProssimo(&it)) != NULL; ++i)
+        ordinati[i] = a->dato;
+
+    if(mOrdine == ALBERO_SNAPSHOT_EYTZINGER)
+    {
+        // Gli elementi dell'ordine di Eytzinger vengono visitati in ordine
+        // crescente e riempiti con i dati ordinati
+        dati = malloc((numero > 0 ? numero : 1) * sizeof(int));
+        if(dati == NULL) goto fine;
+
+        for(i = 0, k = albero_impl_eytzingerPrimo(numero); i < numero;
+            ++i, k = albero_impl_eytzingerSuccessivo(k, numero))
+            dati[k - 1] = ordinati[i];
+    }
+
+    memcpy(testa.magia, "ALBEROSN", 8);
+    testa.versione = ALBERO_SNAPSHOT_VERSIONE;
+    testa.ordine = mOrdine;
+    testa.numero = numero;
+    testa.checksum =
+        albero_impl_checksum(dati != NULL ? dati : ordinati, numero);
+
+    file = fopen(mPercorso, "wb");
+    if(file == NULL) goto fine;
+
+    risultato =
+        fwrite(&testa, sizeof(testa), 1, file) != 1 ||
+        fwrite(dati != NULL ? dati : ordinati, sizeof(int), numero, file) !=
+            numero;
+    risultato |= fclose(file) != 0;
+
+fine:
+    free(dati);
+    free(ordinati);
+    return risultato;
+}
+
+void albero_ChiudiSnapshot(AlberoSnapshot* mS)
+{
+    if(mS->mappa != NULL) munmap(mS->mappa, mS->dimensioneMappa);
+    mS->mappa = NULL;
+}
+
+// Mappa in memoria lo snapshot mPercorso; se mVerifica, controlla anche il
+// checksum (leggendo tutti i dati)
+// Restituisce 1 in caso di errore o se il file non è valido; in quel caso
+// mS->mappa è NULL e albero_ChiudiSnapshot non fa nulla
+int albero_ApriSnapshot(
+    AlberoSnapshot* mS, const char* mPercorso, int mVerifica)
+{
+    const AlberoSnapshotTesta* testa;
+    struct stat info;
+    int descrittore = open(mPercorso, O_RDONLY);
+
+    mS->mappa = NULL;
+    if(descrittore == -1) return 1;
+
+    if(fstat(descrittore, &info) != 0 ||
+        (size_t)info.st_size < sizeof(AlberoSnapshotTesta))
+    {
+        close(descrittore);
+        return 1;
+    }
+
+    mS->dimensioneMappa = info.st_size;
+    mS->mappa =
+        mmap(NULL, mS->dimensioneMappa, PROT_READ, MAP_SHARED, descrittore, 0);
+    close(descrittore);
+
+    if(mS->mappa == MAP_FAILED)
+    {
+        mS->mappa = NULL;
+        return 1;
+    }
+
+    testa = (const AlberoSnapshotTesta*)mS->mappa;
+    mS->dati = (const int*)(testa + 1);
+    mS->numero = testa->numero;
+    mS->ordine = testa->ordine;
+
+    if(memcmp(testa->magia, "ALBEROSN", 8) != 0 ||
+        testa->versione != ALBERO_SNAPSHOT_VERSIONE ||
+        testa->ordine > ALBERO_SNAPSHOT_EYTZINGER ||
+        testa->numero != (mS->dimensioneMappa - sizeof(*testa)) / sizeof(int) ||
+        (mVerifica &&
+            albero_impl_checksum(mS->dati, mS->numero) != testa->checksum))
+    {
+        albero_ChiudiSnapshot(mS);
+        return 1;
+    }
+
+    return 0;
+}
+
+// Restituisce la posizione nello snapshot del primo dato maggiore o uguale
+// a mDato (o maggiore, se mStretto), oppure mS->numero se non esiste
+// Per l'ordine di Eytzinger la discesa è senza salti: il figlio si sceglie
+// con il risultato del confronto
+size_t albero_impl_snapshotCerca(
+    const AlberoSnapshot* mS, int mDato, int mStretto)
+{
+    size_t inizio = 0, fine = mS->numero, k = 1;
+
+    if(mS->ordine == ALBERO_SNAPSHOT_ORDINATO)
+    {
+        while(inizio < fine)
+        {
+            size_t centro = inizio + (fine - inizio) / 2;
+            int d = mS->dati[centro];
+
+            if(d < mDato || (mStretto && d == mDato))
+                inizio = centro + 1;
+            else
+                fine = centro;
+        }
+
+        return inizio;
+    }
+
+    while(k <= mS->numero)
+    {
+        int d = mS->dati[k - 1];
+        k = 2 * k + (d < mDato || (mStretto && d == mDato));
+    }
+
+    // Annulla gli ultimi passi a dx: l'ultimo passo a sx è la risposta
+    k >>= __builtin_ffsl(~k);
+    return k == 0 ? mS->numero : k - 1;
+}
+
+// Restituisce la posizione nello snapshot del dato successivo a quello in
+// posizione mI, oppure mS->numero
+size_t albero_impl_snapshotProssimo(const AlberoSnapshot* mS, size_t mI)
+{
+    size_t k;
+
+    if(mS->ordine == ALBERO_SNAPSHOT_ORDINATO) return mI + 1;
+
+    k = albero_impl_eytzingerSuccessivo(mI + 1, mS->numero);
+    return k == 0 ? mS->numero : k - 1;
+}
+
+// Restituisce 1 se mDato è presente nello snapshot
+int albero_SnapshotRicerca(const AlberoSnapshot* mS, int mDato)
+{
+    size_t i = albero_impl_snapshotCerca(mS, mDato, 0);
+    return i < mS->numero && mS->dati[i] == mDato;
+}
+
+// Scrive in mRisultato il minore dato maggiore di mDato
+// Restituisce 1 se non esiste
+int albero_SnapshotSuccessore(
+    const AlberoSnapshot* mS, int mDato, int* mRisultato)
+{
+    size_t i = albero_impl_snapshotCerca(mS, mDato, 1);
+
+    if(i == mS->numero) return 1;
+
+    *mRisultato = mS->dati[i];
+    return 0;
+}
+
+typedef void (*FPSnapshotVisita)(int, void*);
+
+// Visita in ordine crescente i dati compresi tra mMin e mMax (inclusi),
+// chiamando mFnVisita(dato, mDati) per ciascuno
+// Restituisce il numero di dati visitati
+size_t albero_SnapshotRange(const AlberoSnapshot* mS, int mMin, int mMax,
+    FPSnapshotVisita mFnVisita, void* mDati)
+{
+    size_t i, risultato = 0;
+
+    for(i = albero_impl_snapshotCerca(mS, mMin, 0);
+        i < mS->numero && mS->dati[i] <= mMax;
+        i = albero_impl_snapshotProssimo(mS, i))
+    {
+        (*mFnVisita)(mS->dati[i], mDati);
+        ++risultato;
+    }
+
+    return risultato;
+}
+
+void sommaDati(Albero* mA, void* mSomma) { *(long long*)mSomma += mA->dato; }
+
+void sommaDatiSnapshot(int mDato, void* mSomma)
+{
+    *(long long*)mSomma += mDato;
+}
+
+void contaLivello(int mLivello, size_t mNumero, void* mConteggi)
+{
+    if(mLivello < 64) ((size_t*)mConteggi)[mLivello] = mNumero;
+}
+
+int main()
+{
+    Albero* a;
+
+    albero_Crea(&a, 9);
+
+    albero_Inserisci(a, 5);
+    albero_Inserisci(a, 2);
+    albero_Inserisci(a, 8);
+    albero_Inserisci(a, 12);
+    albero_Inserisci(a, 3);
+    albero_Inserisci(a, 7);
+    albero_Inserisci(a, 10);
+    albero_Inserisci(a, 15);
+    albero_Inserisci(a, 17);
+    albero_Inserisci(a, 4);
+    albero_Inserisci(a, 1);
+    albero_Inserisci(a, 11);
+
+    albero_AttraversaLiv(a);
+
+    printf("\n\n");
+    albero_Rimuovi(albero_Ricerca(a, 5));
+    albero_AttraversaLiv(a);
+
+    printf("\nAltezza: %d", albero_getAltezza(a));
+
+    albero_Distruggi_Ricorsivo(&a);
+
+    {
+        // Inserimento di dati ordinati: un albero non bilanciato
+        // degenererebbe in una lista
+        Albero* rb = NULL;
+        int i, n = 1000000;
+
+#ifdef VL_COUNT_OPS
+        vlops_reset();
+#endif
+
+        for(i = 0; i < n; ++i) albero_InserisciRB(&rb, i);
+
+        printf("\n\nAlbero rosso-nero con %d dati ordinati\n", n);
+        printf("Altezza: %d\n", albero_getAltezza(rb));
+        printf("Altezza nera: %d\n", albero_VerificaRB(rb));
+
+#ifdef VL_COUNT_OPS
+        printf("Per inserimento: %.2f confronti, %.2f nodi visitati, "
+               "%.3f rotazioni\n",
+            (double)vlops_get().comparisons / n, (double)vlops_get().visits / n,
+            (double)vlops_get().moves / n);
+
+        vlops_reset();
+        for(i = 0; i < n; ++i) albero_Ricerca(rb, i);
+        printf("Per ricerca: %.2f confronti, %.2f nodi visitati\n",
+            (double)vlops_get().comparisons / n,
+            (double)vlops_get().visits / n);
+
+        vlops_reset();
+#endif
+
+        for(i = 0; i < n; i += 2) albero_RimuoviRB(&rb, albero_Ricerca(rb, i));
+
+        printf("Dopo la rimozione dei dati pari:\n");
+#ifdef VL_COUNT_OPS
+        // Comprende la ricerca del nodo e la discesa verso il successore
+        printf("Per rimozione: %.2f confronti, %.2f nodi visitati\n",
+            (double)vlops_get().comparisons / (n / 2),
+            (double)vlops_get().visits / (n / 2));
+#endif
+        printf("Altezza: %d\n", albero_getAltezza(rb));
+        printf("Altezza nera: %d\n", albero_VerificaRB(rb));
+        printf("Successore di 501: %d\n",
+            albero_getSuccessore(albero_Ricerca(rb, 501))->dato);
+
+        albero_Distruggi_Ricorsivo(&rb);
+    }
+
+    {
+        // Confronto tra nodi allocati singolarmente e nodi presi da
+        // un'arena, con dati in ordine casuale
+        AlberoArena arena;
+        Albero* rb = NULL;
+        Albero* rbArena = NULL;
+        int i, n = 1000000, trovati = 0;
+        int* dati = malloc(n * sizeof(int));
+        clock_t inizio;
+
+        if(dati == NULL) return 1;
+
+        srand(1);
+        for(i = 0; i < n; ++i)
+            dati[i] = (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+
+        albero_ArenaInizializza(&arena);
+
+        printf(
+            "\nCostruzione di un albero rosso-nero con %d dati casuali\n", n);
+
+        inizio = clock();
+        for(i = 0; i < n; ++i) albero_InserisciRB(&rb, dati[i]);
+        printf("malloc: %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        inizio = clock();
+        for(i = 0; i < n; ++i)
+            albero_ArenaInserisciRB(&arena, &rbArena, dati[i]);
+        printf("Arena:  %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        printf("Ricerca di %d dati\n", n);
+
+        inizio = clock();
+        for(i = 0; i < n; ++i) trovati += albero_Ricerca(rb, dati[i]) != NULL;
+        printf("malloc: %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        inizio = clock();
+        for(i = 0; i < n; ++i)
+            trovati -= albero_Ricerca(rbArena, dati[i]) != NULL;
+        printf("Arena:  %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        assert(trovati == 0);
+
+        printf("Distruzione\n");
+
+        inizio = clock();
+        albero_Distruggi_Ricorsivo(&rb);
+        printf("malloc: %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        inizio = clock();
+        albero_ArenaDistruggi(&arena);
+        rbArena = NULL;
+        printf("Arena:  %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        free(dati);
+    }
+
+    {
+        // Albero degenere (una lista di nodi dx): visite e distruzione non
+        // ricorsive non esauriscono lo stack
+        Albero* lista;
+        Albero* coda;
+        AlberoIteratore it;
+        int i, n = 1000000;
+        long long somma = 0;
+
+        albero_Crea(&lista, 0);
+        for(i = 1, coda = lista; i < n; ++i, coda = coda->dx)
+            albero_CreaFiglio(&coda->dx, coda, i);
+
+        // Nodi collegati direttamente: dimensioni ed altezze vanno
+        // ricalcolate, una sola volta dall'ultimo nodo
+        albero_AggiornaRisalendo(coda);
+
+        printf("\nAlbero degenere di %d nodi\n", n);
+        printf("Altezza: %d\n", albero_getAltezza(lista));
+
+        albero_IteratoreInizia(&it, lista);
+        while((coda = albero_IteratoreProssimo(&it)) != NULL)
+            somma += coda->dato;
+
+        printf("Somma dei dati: %lld\n", somma);
+        printf("Dati tra 1000 e 1999: %d\n",
+            (int)albero_CountRange(lista, 1000, 1999));
+
+        somma = 0;
+        albero_RangeQuery(lista, 10, 19, &sommaDati, &somma);
+        printf("Somma dei dati tra 10 e 19: %lld\n", somma);
+
+        albero_Distruggi_Iterativo(&lista);
+    }
+
+    {
+        // Statistiche per livello di un albero rosso-nero grande
+        Albero* rb = NULL;
+        size_t nodiPerLivello[64] = {0};
+        int i, n = 1000000;
+
+        for(i = 0; i < n; ++i) albero_InserisciRB(&rb, (int)((i * 7919LL) % n));
+
+        albero_AttraversaLivelli(rb, NULL, &contaLivello, nodiPerLivello);
+
+        printf("\nNodi per livello (albero rosso-nero di %d nodi):\n", n);
+        for(i = 0; i < 64 && nodiPerLivello[i] > 0; ++i)
+            printf("%d:%lu ", i, (unsigned long)nodiPerLivello[i]);
+        printf("\n\n");
+
+        albero_Disegna(rb, stdout, 80);
+        albero_Distruggi_Iterativo(&rb);
+    }
+
+#if ALBERO_AUMENTATO
+    {
+        // Statistiche d'ordine: dati 0, 3, 6, ... in ordine casuale
+        Albero* rb = NULL;
+        int i, n = 1000000;
+
+        for(i = 0; i < n; ++i)
+            albero_InserisciRB(&rb, (int)((i * 7919LL) % n) * 3);
+
+        printf("\nStatistiche d'ordine (albero rosso-nero di %d nodi)\n", n);
+        printf("Altezza: %d\n", albero_getAltezza(rb));
+        printf("Dato in posizione 1000: %d\n", albero_Select(rb, 1000)->dato);
+        printf("Posizione di 3000: %d\n",
+            (int)albero_Rank(albero_Ricerca(rb, 3000)));
+        printf("Dati minori di 1000: %d\n", (int)albero_CountLess(rb, 1000));
+        printf("Dati tra 10 e 20: %d\n", (int)albero_CountRange(rb, 10, 20));
+
+        for(i = 0; i < n; i += 2)
+            albero_RimuoviRB(&rb, albero_Select(rb, i / 2));
+
+        printf("Dopo la rimozione di metà dei nodi:\n");
+        printf("Dato in posizione 1000: %d\n", albero_Select(rb, 1000)->dato);
+        printf("Dati minori di 1000: %d\n", (int)albero_CountLess(rb, 1000));
+
+        albero_Distruggi_Iterativo(&rb);
+    }
+#endif
+
+    {
+        // Costruzione da dati ordinati ed inserimento a lotti
+        Albero* rb = NULL;
+        Albero* costruito;
+        int i, n = 1000000, lotto = 200000;
+        int* dati = malloc(n * sizeof(int));
+        clock_t inizio;
+
+        if(dati == NULL) return 1;
+
+        for(i = 0; i < n; ++i) dati[i] = i * 2;
+
+        printf("\nAlbero da %d dati ordinati\n", n);
+
+        inizio = clock();
+        for(i = 0; i < n; ++i) albero_InserisciRB(&rb, dati[i]);
+        printf("albero_InserisciRB:          %f s\n",
+            (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        inizio = clock();
+        costruito = albero_CostruisciDaOrdinato(dati, n);
+        printf("albero_CostruisciDaOrdinato: %f s\n",
+            (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        printf("Altezza: %d, altezza nera: %d\n", albero_getAltezza(costruito),
+            albero_VerificaRB(costruito));
+
+        // Dati dispari in ordine casuale
+        srand(2);
+        for(i = 0; i < lotto; ++i) dati[i] = (rand() % n) * 2 + 1;
+
+        printf("Inserimento di %d dati casuali\n", lotto);
+
+        inizio = clock();
+        for(i = 0; i < lotto; ++i) albero_InserisciRB(&rb, dati[i]);
+        printf("albero_InserisciRB:    %f s\n",
+            (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        inizio = clock();
+        albero_InserisciBatch(&costruito, dati, lotto);
+        printf("albero_InserisciBatch: %f s\n",
+            (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+        printf("Altezza: %d, altezza nera: %d\n", albero_getAltezza(costruito),
+            albero_VerificaRB(costruito));
+
+        albero_Distruggi_Ricorsivo(&rb);
+        albero_Distruggi_Ricorsivo(&costruito);
+        free(dati);
+    }
+
+    {
+        // Un solo dato: la radice costruita deve essere nera, altrimenti i
+        // successivi inserimenti rosso-neri non sono validi
+        Albero* costruito;
+        Albero* lotto = NULL;
+        int x = 5;
+
+        costruito = albero_CostruisciDaOrdinato(&x, 1);
+        albero_InserisciBatch(&lotto, &x, 1);
+
+        albero_InserisciRB(&costruito, 3);
+        albero_InserisciRB(&costruito, 7);
+        albero_InserisciRB(&lotto, 3);
+        albero_InserisciRB(&lotto, 7);
+
+        printf("\nUn solo dato, poi due inserimenti: altezza nera %d (radice "
+               "nera %d) e %d (radice nera %d)\n",
+            albero_VerificaRB(costruito), albero_isNero(costruito),
+            albero_VerificaRB(lotto), albero_isNero(lotto));
+
+        albero_Distruggi_Ricorsivo(&costruito);
+        albero_Distruggi_Ricorsivo(&lotto);
+    }
+
+    {
+        // Snapshot: salvataggio, riapertura tramite mmap e ricerche
+        // direttamente sui dati mappati
+        const char* percorsi[2] = {
+            "albero_ordinato.snap", "albero_eytzinger.snap"};
+        AlberoArena arena;
+        Albero* rb = NULL;
+        int i, o, n = 1000000, trovati, successore = 0;
+        long long somma;
+        clock_t inizio;
+
+        albero_ArenaInizializza(&arena);
+        for(i = 0; i < n; ++i)
+            albero_ArenaInserisciRB(&arena, &rb, (int)((i * 7919LL) % n) * 2);
+
+        printf("\nSnapshot di un albero di %d nodi\n", n);
+
+        inizio = clock();
+        for(i = trovati = 0; i < n; ++i)
+            trovati += albero_Ricerca(rb, i) != NULL;
+        printf("Ricerca nell'albero:   %f s (%d trovati)\n",
+            (double)(clock() - inizio) / CLOCKS_PER_SEC, trovati);
+
+        for(o = ALBERO_SNAPSHOT_ORDINATO; o <= ALBERO_SNAPSHOT_EYTZINGER; ++o)
+        {
+            AlberoSnapshot snapshot;
+
+            if(albero_SalvaSnapshot(rb, percorsi[o], o) != 0) return 1;
+
+            inizio = clock();
+            if(albero_ApriSnapshot(&snapshot, percorsi[o], 0) != 0) return 1;
+            printf("%s: apertura %f s", percorsi[o],
+                (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+            inizio = clock();
+            for(i = trovati = 0; i < n; ++i)
+                trovati += albero_SnapshotRicerca(&snapshot, i);
+            printf(", ricerca %f s (%d trovati)\n",
+                (double)(clock() - inizio) / CLOCKS_PER_SEC, trovati);
+
+            albero_SnapshotSuccessore(&snapshot, 1001, &successore);
+            somma = 0;
+            albero_SnapshotRange(&snapshot, 10, 20, &sommaDatiSnapshot, &somma);
+            printf("Successore di 1001: %d, somma dei dati tra 10 e 20: %lld\n",
+                successore, somma);
+
+            albero_ChiudiSnapshot(&snapshot);
+
+            if(albero_ApriSnapshot(&snapshot, percorsi[o], 1) == 0)
+            {
+                printf("Verifica del checksum: ok\n");
+                albero_ChiudiSnapshot(&snapshot);
+            }
+            else
+                printf("Verifica del checksum: errore\n");
+            remove(percorsi[o]);
+        }
+
+        albero_ArenaDistruggi(&arena);
+    }
 
     return 0;
 }
@@ -0,0 +1,735 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include <time.h>
+
+// B+albero: insieme ordinato di interi con la stessa interfaccia di
+// testAlbero.c (inserimento, ricerca, rimozione, minimo/massimo,
+// successore/predecessore, altezza).
+// Ogni nodo contiene fino ad ALBEROB_CHIAVI chiavi contigue (due linee di
+// cache), quindi una ricerca visita pochi livelli invece di un nodo per
+// livello. Le chiavi stanno tutte nelle foglie, collegate in una lista
+// doppia; i nodi interni contengono solo separatori e figli.
+// L'albero occupa circa 8 byte per chiave, contro i 32 di un nodo di
+// Albero.
+
+#define ALBEROB_CHIAVI 32
+#define ALBEROB_MIN (ALBEROB_CHIAVI / 2 - 1)
+
+// Profondità massima: con almeno ALBEROB_MIN + 1 figli per nodo interno
+// basta ampiamente per qualsiasi numero di chiavi indirizzabile
+#define ALBEROB_MAX_ALTEZZA 16
+
+// Intestazione comune a foglie e nodi interni
+typedef struct
+{
+    int numero; // Chiavi usate
+    int foglia;
+} AlberoBNodo;
+
+struct AlberoBFogliaImpl;
+typedef struct AlberoBFogliaImpl AlberoBFoglia;
+
+struct AlberoBFogliaImpl
+{
+    AlberoBNodo h;
+    AlberoBFoglia* prec;
+    AlberoBFoglia* succ;
+
+    // Le posizioni non usate valgono sempre INT_MAX (vedi
+    // alberoB_impl_conta)
+    int chiavi[ALBEROB_CHIAVI];
+};
+
+typedef struct
+{
+    AlberoBNodo h;
+
+    // figli[i] contiene le chiavi k con chiavi[i - 1] <= k < chiavi[i]
+    int chiavi[ALBEROB_CHIAVI];
+    AlberoBNodo* figli[ALBEROB_CHIAVI + 1];
+} AlberoBInterno;
+
+typedef struct
+{
+    AlberoBNodo* radice;
+    int altezza; // 0 se vuoto, 1 se la radice è una foglia
+    size_t numero;
+    size_t foglie, interni;
+} AlberoB;
+
+// Conta le chiavi minori di mDato (o minori o uguali, se mUguali) tra le
+// prime mNumero
+// Il ciclo scorre sempre tutte le ALBEROB_CHIAVI posizioni, senza salti e
+// senza dipendenze tra iterazioni, quindi il compilatore lo traduce in
+// confronti SIMD. Le posizioni non usate valgono INT_MAX e non vengono
+// contate (tranne che per mDato == INT_MAX, da cui il limite finale).
+int alberoB_impl_conta(const int* mChiavi, int mNumero, int mDato, int mUguali)
+{
+    int i, risultato = 0;
+
+    if(mUguali)
+        for(i = 0; i < ALBEROB_CHIAVI; ++i) risultato += mChiavi[i] <= mDato;
+    else
+        for(i = 0; i < ALBEROB_CHIAVI; ++i) risultato += mChiavi[i] < mDato;
+
+    return risultato < mNumero ? risultato : mNumero;
+}
+
+void alberoB_impl_svuota(int* mChiavi, int mDa)
+{
+    for(; mDa < ALBEROB_CHIAVI; ++mDa) mChiavi[mDa] = INT_MAX;
+}
+
+int* alberoB_impl_chiavi(AlberoBNodo* mN)
+{
+    return mN->foglia ? ((AlberoBFoglia*)mN)->chiavi
+                      : ((AlberoBInterno*)mN)->chiavi;
+}
+
+// Restituisce NULL in caso di errore
+AlberoBFoglia* alberoB_impl_creaFoglia(AlberoB* mA)
+{
+    AlberoBFoglia* f = malloc(sizeof(AlberoBFoglia));
+    if(f == NULL) return NULL;
+
+    f->h.numero = 0;
+    f->h.foglia = 1;
+    f->prec = f->succ = NULL;
+    alberoB_impl_svuota(f->chiavi, 0);
+
+    ++mA->foglie;
+    return f;
+}
+
+// Restituisce NULL in caso di errore
+AlberoBInterno* alberoB_impl_creaInterno(AlberoB* mA)
+{
+    AlberoBInterno* n = malloc(sizeof(AlberoBInterno));
+    if(n == NULL) return NULL;
+
+    n->h.numero = 0;
+    n->h.foglia = 0;
+    alberoB_impl_svuota(n->chiavi, 0);
+
+    ++mA->interni;
+    return n;
+}
+
+void alberoB_impl_distruggiNodo(AlberoB* mA, AlberoBNodo* mN)
+{
+    if(mN->foglia)
+        --mA->foglie;
+    else
+        --mA->interni;
+
+    free(mN);
+}
+
+void alberoB_Crea(AlberoB* mA)
+{
+    mA->radice = NULL;
+    mA->altezza = 0;
+    mA->numero = mA->foglie = mA->interni = 0;
+}
+
+void alberoB_impl_distruggiRicorsivo(AlberoB* mA, AlberoBNodo* mN)
+{
+    int i;
+
+    // La ricorsione è limitata dall'altezza, che è logaritmica
+    if(!mN->foglia)
+        for(i = 0; i <= mN->numero; ++i)
+            alberoB_impl_distruggiRicorsivo(
+                mA, ((AlberoBInterno*)mN)->figli[i]);
+
+    alberoB_impl_distruggiNodo(mA, mN);
+}
+
+void alberoB_Distruggi(AlberoB* mA)
+{
+    if(mA->radice != NULL) alberoB_impl_distruggiRicorsivo(mA, mA->radice);
+    alberoB_Crea(mA);
+}
+
+// Scende fino alla foglia che contiene (o conterrebbe) mDato
+// Se mPercorso non è NULL, vi scrive i nodi interni attraversati e in
+// mIndici la posizione del figlio scelto in ciascuno
+AlberoBFoglia* alberoB_impl_scendi(const AlberoB* mA, int mDato,
+    AlberoBInterno** mPercorso, int* mIndici)
+{
+    AlberoBNodo* n = mA->radice;
+    int livello = 0;
+
+    while(!n->foglia)
+    {
+        AlberoBInterno* interno = (AlberoBInterno*)n;
+        int i = alberoB_impl_conta(interno->chiavi, n->numero, mDato, 1);
+
+        if(mPercorso != NULL)
+        {
+            mPercorso[livello] = interno;
+            mIndici[livello] = i;
+        }
+
+        ++livello;
+        n = interno->figli[i];
+    }
+
+    return (AlberoBFoglia*)n;
+}
+
+// Restituisce 1 se mDato è presente
+int alberoB_Ricerca(const AlberoB* mA, int mDato)
+{
+    AlberoBFoglia* f;
+    int i;
+
+    if(mA->radice == NULL) return 0;
+
+    f = alberoB_impl_scendi(mA, mDato, NULL, NULL);
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 0);
+
+    return i < f->h.numero && f->chiavi[i] == mDato;
+}
+
+// Inserisce mChiave in posizione mI di mChiavi, che ne contiene mNumero
+void alberoB_impl_inserisciChiave(
+    int* mChiavi, int mNumero, int mI, int mChiave)
+{
+    int j;
+    for(j = mNumero; j > mI; --j) mChiavi[j] = mChiavi[j - 1];
+    mChiavi[mI] = mChiave;
+}
+
+// Inserisce il separatore mChiave ed il figlio destro mFiglio nel nodo
+// interno mN, nella posizione mI (mN non deve essere pieno)
+void alberoB_impl_inserisciInInterno(
+    AlberoBInterno* mN, int mI, int mChiave, AlberoBNodo* mFiglio)
+{
+    int j;
+
+    alberoB_impl_inserisciChiave(mN->chiavi, mN->h.numero, mI, mChiave);
+    for(j = mN->h.numero + 1; j > mI + 1; --j) mN->figli[j] = mN->figli[j - 1];
+    mN->figli[mI + 1] = mFiglio;
+
+    ++mN->h.numero;
+}
+
+// Inserisce mDato nell'insieme
+// Restituisce 1 in caso di errore o se il dato è già presente
+int alberoB_Inserisci(AlberoB* mA, int mDato)
+{
+    AlberoBInterno* percorso[ALBEROB_MAX_ALTEZZA];
+    int indici[ALBEROB_MAX_ALTEZZA];
+    AlberoBFoglia* f;
+    AlberoBFoglia* nuova;
+    AlberoBNodo* figlio;
+    int i, livello, separatore, meta = ALBEROB_CHIAVI / 2;
+
+    if(mA->radice == NULL)
+    {
+        f = alberoB_impl_creaFoglia(mA);
+        if(f == NULL) return 1;
+
+        mA->radice = &f->h;
+        mA->altezza = 1;
+    }
+
+    f = alberoB_impl_scendi(mA, mDato, percorso, indici);
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 0);
+
+    if(i < f->h.numero && f->chiavi[i] == mDato) return 1;
+
+    if(f->h.numero < ALBEROB_CHIAVI)
+    {
+        alberoB_impl_inserisciChiave(f->chiavi, f->h.numero++, i, mDato);
+        ++mA->numero;
+        return 0;
+    }
+
+    // Foglia piena: la metà superiore passa in una nuova foglia, la prima
+    // chiave della nuova foglia diventa il separatore da inserire nel padre
+    nuova = alberoB_impl_creaFoglia(mA);
+    if(nuova == NULL) return 1;
+
+    for(i = meta; i < ALBEROB_CHIAVI; ++i)
+        nuova->chiavi[i - meta] = f->chiavi[i];
+    alberoB_impl_svuota(f->chiavi, meta);
+    f->h.numero = meta;
+    nuova->h.numero = ALBEROB_CHIAVI - meta;
+
+    nuova->prec = f;
+    nuova->succ = f->succ;
+    if(f->succ != NULL) f->succ->prec = nuova;
+    f->succ = nuova;
+
+    if(mDato >= nuova->chiavi[0]) f = nuova;
+
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 0);
+    alberoB_impl_inserisciChiave(f->chiavi, f->h.numero++, i, mDato);
+    ++mA->numero;
+
+    separatore = nuova->chiavi[0];
+    figlio = &nuova->h;
+
+    // Risale il percorso finchè un nodo interno ha spazio per il separatore
+    for(livello = mA->altezza - 2; livello >= 0; --livello)
+    {
+        AlberoBInterno* n = percorso[livello];
+        AlberoBInterno* destro;
+        int salito;
+
+        i = indici[livello];
+
+        if(n->h.numero < ALBEROB_CHIAVI)
+        {
+            alberoB_impl_inserisciInInterno(n, i, separatore, figlio);
+            return 0;
+        }
+
+        // Nodo interno pieno: la chiave centrale sale al padre, quelle
+        // successive (con i loro figli) passano in un nuovo nodo
+        destro = alberoB_impl_creaInterno(mA);
+        if(destro == NULL) return 1;
+
+        salito = n->chiavi[meta];
+        destro->h.numero = ALBEROB_CHIAVI - meta - 1;
+        for(i = 0; i < destro->h.numero; ++i)
+        {
+            destro->chiavi[i] = n->chiavi[meta + 1 + i];
+            destro->figli[i] = n->figli[meta + 1 + i];
+        }
+        destro->figli[i] = n->figli[ALBEROB_CHIAVI];
+
+        alberoB_impl_svuota(n->chiavi, meta);
+        n->h.numero = meta;
+
+        i = indici[livello];
+        if(i <= meta)
+            alberoB_impl_inserisciInInterno(n, i, separatore, figlio);
+        else
+            alberoB_impl_inserisciInInterno(
+                destro, i - meta - 1, separatore, figlio);
+
+        separatore = salito;
+        figlio = &destro->h;
+    }
+
+    // Anche la radice si è divisa: l'albero cresce di un livello
+    {
+        AlberoBInterno* radice = alberoB_impl_creaInterno(mA);
+        if(radice == NULL) return 1;
+
+        radice->h.numero = 1;
+        radice->chiavi[0] = separatore;
+        radice->figli[0] = mA->radice;
+        radice->figli[1] = figlio;
+
+        mA->radice = &radice->h;
+        ++mA->altezza;
+    }
+
+    return 0;
+}
+
+// Rimuove la chiave (ed il figlio destro) in posizione mI dal nodo
+// interno mN
+void alberoB_impl_rimuoviDaInterno(AlberoBInterno* mN, int mI)
+{
+    int j;
+
+    for(j = mI; j < mN->h.numero - 1; ++j)
+    {
+        mN->chiavi[j] = mN->chiavi[j + 1];
+        mN->figli[j + 1] = mN->figli[j + 2];
+    }
+
+    mN->chiavi[--mN->h.numero] = INT_MAX;
+}
+
+// Unisce il figlio mI + 1 di mPadre nel figlio mI, eliminando il
+// separatore tra i due
+void alberoB_impl_unisci(AlberoB* mA, AlberoBInterno* mPadre, int mI)
+{
+    AlberoBNodo* sx = mPadre->figli[mI];
+    AlberoBNodo* dx = mPadre->figli[mI + 1];
+    int j;
+
+    if(sx->foglia)
+    {
+        AlberoBFoglia* fSx = (AlberoBFoglia*)sx;
+        AlberoBFoglia* fDx = (AlberoBFoglia*)dx;
+
+        for(j = 0; j < dx->numero; ++j)
+            fSx->chiavi[sx->numero + j] = fDx->chiavi[j];
+
+        fSx->succ = fDx->succ;
+        if(fDx->succ != NULL) fDx->succ->prec = fSx;
+    }
+    else
+    {
+        AlberoBInterno* iSx = (AlberoBInterno*)sx;
+        AlberoBInterno* iDx = (AlberoBInterno*)dx;
+
+        // Nei nodi interni il separatore scende tra le chiavi dei due nodi
+        iSx->chiavi[sx->numero++] = mPadre->chiavi[mI];
+
+        for(j = 0; j < dx->numero; ++j)
+        {
+            iSx->chiavi[sx->numero + j] = iDx->chiavi[j];
+            iSx->figli[sx->numero + j] = iDx->figli[j];
+        }
+        iSx->figli[sx->numero + j] = iDx->figli[j];
+    }
+
+    sx->numero += dx->numero;
+    alberoB_impl_rimuoviDaInterno(mPadre, mI);
+    alberoB_impl_distruggiNodo(mA, dx);
+}
+
+// Sposta una chiave nel figlio mI di mPadre dal fratello sinistro
+void alberoB_impl_prendiDaSx(AlberoBInterno* mPadre, int mI)
+{
+    AlberoBNodo* n = mPadre->figli[mI];
+    AlberoBNodo* sx = mPadre->figli[mI - 1];
+    int* chiaviSx = alberoB_impl_chiavi(sx);
+    int j;
+
+    if(n->foglia)
+    {
+        AlberoBFoglia* f = (AlberoBFoglia*)n;
+
+        alberoB_impl_inserisciChiave(f->chiavi, n->numero, 0,
+            chiaviSx[sx->numero - 1]);
+        mPadre->chiavi[mI - 1] = f->chiavi[0];
+    }
+    else
+    {
+        AlberoBInterno* interno = (AlberoBInterno*)n;
+
+        alberoB_impl_inserisciChiave(
+            interno->chiavi, n->numero, 0, mPadre->chiavi[mI - 1]);
+        for(j = n->numero + 1; j > 0; --j)
+            interno->figli[j] = interno->figli[j - 1];
+        interno->figli[0] = ((AlberoBInterno*)sx)->figli[sx->numero];
+
+        mPadre->chiavi[mI - 1] = chiaviSx[sx->numero - 1];
+    }
+
+    ++n->numero;
+    chiaviSx[--sx->numero] = INT_MAX;
+}
+
+// Sposta una chiave nel figlio mI di mPadre dal fratello destro
+void alberoB_impl_prendiDaDx(AlberoBInterno* mPadre, int mI)
+{
+    AlberoBNodo* n = mPadre->figli[mI];
+    AlberoBNodo* dx = mPadre->figli[mI + 1];
+    int* chiaviDx = alberoB_impl_chiavi(dx);
+    int j;
+
+    if(n->foglia)
+    {
+        ((AlberoBFoglia*)n)->chiavi[n->numero] = chiaviDx[0];
+        for(j = 0; j < dx->numero - 1; ++j) chiaviDx[j] = chiaviDx[j + 1];
+        mPadre->chiavi[mI] = chiaviDx[0];
+    }
+    else
+    {
+        AlberoBInterno* interno = (AlberoBInterno*)n;
+        AlberoBInterno* iDx = (AlberoBInterno*)dx;
+
+        interno->chiavi[n->numero] = mPadre->chiavi[mI];
+        interno->figli[n->numero + 1] = iDx->figli[0];
+        mPadre->chiavi[mI] = chiaviDx[0];
+
+        for(j = 0; j < dx->numero - 1; ++j)
+        {
+            chiaviDx[j] = chiaviDx[j + 1];
+            iDx->figli[j] = iDx->figli[j + 1];
+        }
+        iDx->figli[j] = iDx->figli[j + 1];
+    }
+
+    ++n->numero;
+    chiaviDx[--dx->numero] = INT_MAX;
+}
+
+// Rimuove mDato dall'insieme
+// Restituisce 1 se il dato non è presente
+int alberoB_Rimuovi(AlberoB* mA, int mDato)
+{
+    AlberoBInterno* percorso[ALBEROB_MAX_ALTEZZA];
+    int indici[ALBEROB_MAX_ALTEZZA];
+    AlberoBFoglia* f;
+    AlberoBNodo* n;
+    int i, j, livello;
+
+    if(mA->radice == NULL) return 1;
+
+    f = alberoB_impl_scendi(mA, mDato, percorso, indici);
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 0);
+
+    if(i == f->h.numero || f->chiavi[i] != mDato) return 1;
+
+    for(j = i; j < f->h.numero - 1; ++j) f->chiavi[j] = f->chiavi[j + 1];
+    f->chiavi[--f->h.numero] = INT_MAX;
+    --mA->numero;
+
+    // I separatori restano validi anche se la chiave rimossa era la prima
+    // della foglia: servono solo a dividere gli intervalli
+    n = &f->h;
+
+    // Risale finchè un nodo ha meno di ALBEROB_MIN chiavi, prendendo una
+    // chiave da un fratello o unendolo ad esso
+    for(livello = mA->altezza - 2;
+        livello >= 0 && n->numero < ALBEROB_MIN; --livello)
+    {
+        AlberoBInterno* padre = percorso[livello];
+        i = indici[livello];
+
+        if(i > 0 && padre->figli[i - 1]->numero > ALBEROB_MIN)
+            alberoB_impl_prendiDaSx(padre, i);
+        else if(i < padre->h.numero &&
+                padre->figli[i + 1]->numero > ALBEROB_MIN)
+            alberoB_impl_prendiDaDx(padre, i);
+        else if(i > 0)
+            alberoB_impl_unisci(mA, padre, i - 1);
+        else
+            alberoB_impl_unisci(mA, padre, i);
+
+        n = &padre->h;
+    }
+
+    // La radice interna rimasta senza separatori viene sostituita dal suo
+    // unico figlio, la radice foglia vuota viene eliminata
+    n = mA->radice;
+
+    if(!n->foglia && n->numero == 0)
+    {
+        mA->radice = ((AlberoBInterno*)n)->figli[0];
+        --mA->altezza;
+        alberoB_impl_distruggiNodo(mA, n);
+    }
+    else if(n->foglia && n->numero == 0)
+    {
+        alberoB_impl_distruggiNodo(mA, n);
+        mA->radice = NULL;
+        mA->altezza = 0;
+    }
+
+    return 0;
+}
+
+AlberoBFoglia* alberoB_impl_fogliaEstrema(const AlberoB* mA, int mUltima)
+{
+    AlberoBNodo* n = mA->radice;
+
+    while(!n->foglia)
+        n = ((AlberoBInterno*)n)->figli[mUltima ? n->numero : 0];
+
+    return (AlberoBFoglia*)n;
+}
+
+// Scrive in mRisultato il dato minimo
+// Restituisce 1 se l'insieme è vuoto
+int alberoB_getMinimo(const AlberoB* mA, int* mRisultato)
+{
+    if(mA->radice == NULL) return 1;
+
+    *mRisultato = alberoB_impl_fogliaEstrema(mA, 0)->chiavi[0];
+    return 0;
+}
+
+// Scrive in mRisultato il dato massimo
+// Restituisce 1 se l'insieme è vuoto
+int alberoB_getMassimo(const AlberoB* mA, int* mRisultato)
+{
+    AlberoBFoglia* f;
+
+    if(mA->radice == NULL) return 1;
+
+    f = alberoB_impl_fogliaEstrema(mA, 1);
+    *mRisultato = f->chiavi[f->h.numero - 1];
+    return 0;
+}
+
+// Scrive in mRisultato il minore dato maggiore di mDato (mDato può non
+// essere presente)
+// Restituisce 1 se non esiste
+int alberoB_getSuccessore(const AlberoB* mA, int mDato, int* mRisultato)
+{
+    AlberoBFoglia* f;
+    int i;
+
+    if(mA->radice == NULL) return 1;
+
+    f = alberoB_impl_scendi(mA, mDato, NULL, NULL);
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 1);
+
+    if(i == f->h.numero)
+    {
+        // Le foglie diverse dalla radice non sono mai vuote
+        f = f->succ;
+        i = 0;
+        if(f == NULL) return 1;
+    }
+
+    *mRisultato = f->chiavi[i];
+    return 0;
+}
+
+// Scrive in mRisultato il maggiore dato minore di mDato (mDato può non
+// essere presente)
+// Restituisce 1 se non esiste
+int alberoB_getPredecessore(const AlberoB* mA, int mDato, int* mRisultato)
+{
+    AlberoBFoglia* f;
+    int i;
+
+    if(mA->radice == NULL) return 1;
+
+    f = alberoB_impl_scendi(mA, mDato, NULL, NULL);
+    i = alberoB_impl_conta(f->chiavi, f->h.numero, mDato, 0);
+
+    if(i == 0)
+    {
+        f = f->prec;
+        if(f == NULL) return 1;
+        i = f->h.numero;
+    }
+
+    *mRisultato = f->chiavi[i - 1];
+    return 0;
+}
+
+int alberoB_getAltezza(const AlberoB* mA) { return mA->altezza; }
+
+// Memoria occupata dai nodi, in byte
+size_t alberoB_getMemoria(const AlberoB* mA)
+{
+    return mA->foglie * sizeof(AlberoBFoglia) +
+           mA->interni * sizeof(AlberoBInterno);
+}
+
+// Verifica ordinamento, separatori, riempimento dei nodi, posizioni non
+// usate e collegamenti tra le foglie
+// Restituisce il numero di chiavi nel sottoalbero, oppure -1 se non è
+// valido. Le chiavi ammesse k sono quelle con mMin <= k < mMax
+long alberoB_impl_verifica(const AlberoB* mA, const AlberoBNodo* mN,
+    long long mMin, long long mMax, int mRadice)
+{
+    const int* chiavi = alberoB_impl_chiavi((AlberoBNodo*)mN);
+    long totale = 0, parziale;
+    int i;
+
+    if(!mRadice && mN->numero < ALBEROB_MIN) return -1;
+
+    for(i = 0; i < ALBEROB_CHIAVI; ++i)
+    {
+        if(i >= mN->numero)
+        {
+            if(chiavi[i] != INT_MAX) return -1;
+            continue;
+        }
+
+        if(chiavi[i] < mMin || chiavi[i] >= mMax) return -1;
+        if(i > 0 && chiavi[i] <= chiavi[i - 1]) return -1;
+    }
+
+    if(mN->foglia)
+    {
+        const AlberoBFoglia* f = (const AlberoBFoglia*)mN;
+
+        if(f->succ != NULL && f->succ->prec != f) return -1;
+        if(f->succ != NULL && f->succ->chiavi[0] <= f->chiavi[mN->numero - 1])
+            return -1;
+
+        return mN->numero;
+    }
+
+    for(i = 0; i <= mN->numero; ++i)
+    {
+        parziale = alberoB_impl_verifica(mA,
+            ((const AlberoBInterno*)mN)->figli[i],
+            i == 0 ? mMin : chiavi[i - 1],
+            i == mN->numero ? mMax : chiavi[i], 0);
+
+        if(parziale == -1) return -1;
+        totale += parziale;
+    }
+
+    return totale;
+}
+
+// Restituisce 1 se l'albero non è valido
+int alberoB_Verifica(const AlberoB* mA)
+{
+    if(mA->radice == NULL) return mA->numero != 0;
+
+    return alberoB_impl_verifica(mA, mA->radice, LLONG_MIN,
+               (long long)INT_MAX + 1, 1) != (long)mA->numero;
+}
+
+int main()
+{
+    AlberoB a;
+    int i, n = 10000000, trovati = 0, risultato = 0;
+    int* dati = malloc(n * sizeof(int));
+    clock_t inizio;
+
+    if(dati == NULL) return 1;
+
+    alberoB_Crea(&a);
+
+    for(i = 20; i > 0; --i) alberoB_Inserisci(&a, i * 5);
+    alberoB_Rimuovi(&a, 50);
+
+    alberoB_getMinimo(&a, &risultato);
+    printf("Minimo: %d\n", risultato);
+    alberoB_getMassimo(&a, &risultato);
+    printf("Massimo: %d\n", risultato);
+    alberoB_getSuccessore(&a, 45, &risultato);
+    printf("Successore di 45: %d\n", risultato);
+    alberoB_getPredecessore(&a, 53, &risultato);
+    printf("Predecessore di 53: %d\n", risultato);
+    printf("Ricerca di 50: %d\n", alberoB_Ricerca(&a, 50));
+
+    alberoB_Distruggi(&a);
+
+    srand(1);
+    for(i = 0; i < n; ++i)
+        dati[i] = (int)(((unsigned)rand() << 16) ^ (unsigned)rand());
+
+    printf("\nB+albero con %d dati casuali\n", n);
+
+    inizio = clock();
+    for(i = 0; i < n; ++i) alberoB_Inserisci(&a, dati[i]);
+    printf("Costruzione: %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+    inizio = clock();
+    for(i = 0; i < n; ++i) trovati += alberoB_Ricerca(&a, dati[i]);
+    printf("Ricerca:     %f s\n", (double)(clock() - inizio) / CLOCKS_PER_SEC);
+
+    printf("Dati distinti: %d\n", (int)a.numero);
+    printf("Altezza: %d\n", alberoB_getAltezza(&a));
+    printf("Byte per dato: %f (Albero: %d)\n",
+        (double)alberoB_getMemoria(&a) / a.numero, 32);
+    printf("Valido: %s\n", alberoB_Verifica(&a) ? "no" : "si");
+
+    assert(trovati == n);
+
+    for(i = 0; i < n; i += 2) alberoB_Rimuovi(&a, dati[i]);
+
+    printf("Dopo la rimozione di metà dei dati: %d dati, altezza %d, "
+           "valido: %s\n",
+        (int)a.numero, alberoB_getAltezza(&a),
+        alberoB_Verifica(&a) ? "no" : "si");
+
+    alberoB_Distruggi(&a);
+    free(dati);
+
+    return 0;
+}
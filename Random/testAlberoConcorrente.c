@@ -0,0 +1,911 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+
+// Albero binario di ricerca concorrente
+// - I lettori (alberoC_Ricerca) non usano lock: attraversano l'albero con
+//   sole letture acquire dei puntatori ai figli.
+// - Gli scrittori usano un mutex per partizione: l'insieme degli interi è
+//   diviso, tramite un hash, in ALBEROC_PARTI partizioni, ognuna con il
+//   proprio albero, quindi scritture su partizioni diverse procedono in
+//   parallelo. L'hash distribuisce anche dati vicini, ma le partizioni non
+//   sono ordinate tra loro: le visite in ordine (alberoC_VisitaIntervallo)
+//   fondono quelle delle partizioni.
+//   Un nodo viene pubblicato solo quando è completamente inizializzato, ed
+//   un nodo rimosso non viene modificato, quindi un lettore che lo sta
+//   attraversando prosegue correttamente. Rimuovendo un nodo con due figli
+//   il cammino fino al successore viene copiato e pubblicato con un'unica
+//   scrittura, quindi gli scrittori non attendono mai i lettori.
+// - Ogni albero è uno scapegoat tree: la profondità resta O(log n) anche
+//   con dati inseriti in ordine, ricostruendo (per copia) i sottoalberi
+//   sbilanciati.
+// - I nodi rimossi vengono deallocati con un meccanismo ad epoche (QSBR):
+//   ogni thread registrato segnala periodicamente, con alberoC_Quiescente,
+//   di non avere riferimenti a nodi; un nodo rimosso all'epoca E viene
+//   deallocato quando tutti i thread hanno segnalato un'epoca maggiore.
+// A differenza di testAlbero.c i nodi non hanno il puntatore al padre, che
+// andrebbe aggiornato atomicamente insieme ai figli.
+
+#define ALBEROC_PARTI 64
+#define ALBEROC_BIT_PARTI 6
+#define ALBEROC_MAX_THREADS 64
+
+// Numero di nodi rimossi dopo il quale una partizione prova a deallocarli
+#define ALBEROC_RACCOLTA 64
+
+// Limite alla profondità di un albero: log_1.5(2^32) < 55, più i due
+// livelli che un inserimento può aggiungere prima di ribilanciare
+#define ALBEROC_MAX_PROFONDITA 64
+
+struct AlberoCNodoImpl;
+typedef struct AlberoCNodoImpl AlberoCNodo;
+
+struct AlberoCNodoImpl
+{
+    AlberoCNodo* sx;
+    AlberoCNodo* dx;
+    int dato;
+};
+
+typedef struct
+{
+    AlberoCNodo* nodo;
+    unsigned long epoca;
+} AlberoCRitirato;
+
+typedef struct
+{
+    AlberoCNodo* radice;
+    pthread_mutex_t mutex;
+
+    // Nodi nell'albero, e massimo raggiunto dall'ultima ricostruzione
+    // completa, protetti da mutex
+    size_t numero, massimo;
+
+    // Nodi rimossi non ancora deallocati, protetti da mutex
+    AlberoCRitirato* ritirati;
+    size_t numeroRitirati, capacitaRitirati, prossimaRaccolta;
+} AlberoCParte;
+
+// Ultima epoca segnalata da un thread, 0 se il thread non è registrato
+// Occupa una linea di cache per evitare false condivisioni
+typedef struct
+{
+    unsigned long epoca;
+    char padding[64 - sizeof(unsigned long)];
+} AlberoCThread;
+
+typedef struct
+{
+    AlberoCParte parti[ALBEROC_PARTI];
+    AlberoCThread threads[ALBEROC_MAX_THREADS];
+    unsigned long epoca;
+} AlberoC;
+
+// Restituisce la partizione contenente mDato
+// I bit alti di mDato moltiplicato per 2^32 / phi (hash di Fibonacci): anche
+// dati vicini tra loro, che avrebbero gli stessi bit alti, vengono
+// distribuiti su tutte le partizioni
+AlberoCParte* alberoC_impl_parte(AlberoC* mA, int mDato)
+{
+    return &mA->parti[((unsigned int)mDato * 2654435769u) >>
+                      (32 - ALBEROC_BIT_PARTI)];
+}
+
+AlberoCNodo* alberoC_impl_leggi(AlberoCNodo** mP)
+{
+    return __atomic_load_n(mP, __ATOMIC_ACQUIRE);
+}
+
+void alberoC_impl_pubblica(AlberoCNodo** mP, AlberoCNodo* mNodo)
+{
+    __atomic_store_n(mP, mNodo, __ATOMIC_RELEASE);
+}
+
+// Restituisce 1 in caso di errore
+int alberoC_Crea(AlberoC* mA)
+{
+    int i;
+
+    for(i = 0; i < ALBEROC_PARTI; ++i)
+    {
+        mA->parti[i].radice = NULL;
+        mA->parti[i].numero = mA->parti[i].massimo = 0;
+        mA->parti[i].ritirati = NULL;
+        mA->parti[i].numeroRitirati = mA->parti[i].capacitaRitirati = 0;
+        mA->parti[i].prossimaRaccolta = ALBEROC_RACCOLTA;
+
+        if(pthread_mutex_init(&mA->parti[i].mutex, NULL) != 0)
+        {
+            while(i-- > 0) pthread_mutex_destroy(&mA->parti[i].mutex);
+            return 1;
+        }
+    }
+
+    for(i = 0; i < ALBEROC_MAX_THREADS; ++i) mA->threads[i].epoca = 0;
+    mA->epoca = 1;
+
+    return 0;
+}
+
+// Dealloca un sottoalbero senza ricorsione: ruota a destra finchè la
+// radice ha un figlio sx, poi la dealloca e prosegue con il figlio dx
+void alberoC_impl_distruggiSottoalbero(AlberoCNodo* mN)
+{
+    while(mN != NULL)
+    {
+        AlberoCNodo* prossimo;
+
+        if(mN->sx != NULL)
+        {
+            prossimo = mN->sx;
+            mN->sx = prossimo->dx;
+            prossimo->dx = mN;
+        }
+        else
+        {
+            prossimo = mN->dx;
+            free(mN);
+        }
+
+        mN = prossimo;
+    }
+}
+
+// Non deve essere chiamata mentre altri thread usano l'albero
+void alberoC_Distruggi(AlberoC* mA)
+{
+    size_t j;
+    int i;
+
+    for(i = 0; i < ALBEROC_PARTI; ++i)
+    {
+        AlberoCParte* p = &mA->parti[i];
+
+        alberoC_impl_distruggiSottoalbero(p->radice);
+        for(j = 0; j < p->numeroRitirati; ++j) free(p->ritirati[j].nodo);
+
+        free(p->ritirati);
+        pthread_mutex_destroy(&p->mutex);
+    }
+}
+
+// Registra il thread mThread (0 <= mThread < ALBEROC_MAX_THREADS) prima
+// che usi l'albero
+void alberoC_Registra(AlberoC* mA, int mThread)
+{
+    __atomic_store_n(&mA->threads[mThread].epoca,
+        __atomic_load_n(&mA->epoca, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// Il thread mThread non userà più l'albero (finchè non si registra di nuovo)
+void alberoC_Deregistra(AlberoC* mA, int mThread)
+{
+    __atomic_store_n(&mA->threads[mThread].epoca, 0, __ATOMIC_RELEASE);
+}
+
+// Segnala che il thread mThread non ha riferimenti a nodi dell'albero
+// (cioè che non è dentro una alberoC_Ricerca)
+// Ogni thread registrato deve chiamarla regolarmente: le rimozioni
+// aspettano i thread che non la chiamano
+void alberoC_Quiescente(AlberoC* mA, int mThread)
+{
+    __atomic_store_n(&mA->threads[mThread].epoca,
+        __atomic_load_n(&mA->epoca, __ATOMIC_SEQ_CST), __ATOMIC_RELEASE);
+}
+
+// Restituisce la minore epoca segnalata dai thread registrati
+// La barriera fa coppia con quella di alberoC_Registra: o questo thread
+// vede la registrazione, o il thread registrato vede i nodi già scollegati
+// (con sole letture acquire entrambi potrebbero leggere i valori vecchi e
+// un nodo ancora in uso verrebbe deallocato)
+unsigned long alberoC_impl_epocaMinima(AlberoC* mA)
+{
+    unsigned long risultato;
+    int i;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    risultato = __atomic_load_n(&mA->epoca, __ATOMIC_SEQ_CST);
+
+    for(i = 0; i < ALBEROC_MAX_THREADS; ++i)
+    {
+        unsigned long e =
+            __atomic_load_n(&mA->threads[i].epoca, __ATOMIC_SEQ_CST);
+        if(e != 0 && e < risultato) risultato = e;
+    }
+
+    return risultato;
+}
+
+// Fa spazio per altri mNumero nodi rimossi nella partizione (con il suo
+// mutex bloccato)
+// Restituisce 1 in caso di errore
+int alberoC_impl_riserva(AlberoCParte* mP, size_t mNumero)
+{
+    size_t capacita = mP->capacitaRitirati ? mP->capacitaRitirati
+                                           : ALBEROC_RACCOLTA;
+    AlberoCRitirato* r;
+
+    if(mP->numeroRitirati + mNumero <= mP->capacitaRitirati) return 0;
+
+    while(capacita < mP->numeroRitirati + mNumero) capacita *= 2;
+
+    r = realloc(mP->ritirati, capacita * sizeof(AlberoCRitirato));
+    if(r == NULL) return 1;
+
+    mP->ritirati = r;
+    mP->capacitaRitirati = capacita;
+    return 0;
+}
+
+// Aggiunge gli mNumero nodi di mNodi ai nodi rimossi della partizione (con
+// il suo mutex bloccato)
+// Restituisce 1 in caso di errore; non fallisce se lo spazio è già stato
+// riservato con alberoC_impl_riserva
+int alberoC_impl_ritira(
+    AlberoC* mA, AlberoCParte* mP, AlberoCNodo** mNodi, size_t mNumero)
+{
+    unsigned long epoca;
+    size_t i, rimasti;
+
+    if(alberoC_impl_riserva(mP, mNumero) != 0) return 1;
+
+    // Un thread che segnala un'epoca maggiore di questa ha terminato ogni
+    // ricerca iniziata prima della rimozione dei nodi
+    epoca = __atomic_fetch_add(&mA->epoca, 1, __ATOMIC_SEQ_CST);
+    for(i = 0; i < mNumero; ++i)
+    {
+        mP->ritirati[mP->numeroRitirati].nodo = mNodi[i];
+        mP->ritirati[mP->numeroRitirati].epoca = epoca;
+        ++mP->numeroRitirati;
+    }
+
+    if(mP->numeroRitirati >= mP->prossimaRaccolta)
+    {
+        unsigned long minima = alberoC_impl_epocaMinima(mA);
+
+        for(i = rimasti = 0; i < mP->numeroRitirati; ++i)
+        {
+            if(mP->ritirati[i].epoca < minima)
+                free(mP->ritirati[i].nodo);
+            else
+                mP->ritirati[rimasti++] = mP->ritirati[i];
+        }
+
+        mP->numeroRitirati = rimasti;
+        mP->prossimaRaccolta = rimasti + ALBEROC_RACCOLTA;
+    }
+
+    return 0;
+}
+
+// Bilanciamento (scapegoat tree, con alfa = 2/3)
+// Un albero di n nodi non deve essere più profondo di log_1.5(n): quando un
+// inserimento lo supera, si risale il cammino fino al primo antenato con un
+// figlio di più di 2/3 dei suoi nodi (esiste sempre) e se ne ricostruisce
+// il sottoalbero perfettamente bilanciato. Quando le rimozioni portano i
+// nodi sotto 2/3 del massimo raggiunto si ricostruisce l'intero albero.
+// Le ricostruzioni sono fatte di copie, pubblicate con un'unica scrittura
+// come la copia del cammino di alberoC_Rimuovi; in media costano O(log n)
+// per operazione.
+
+// Restituisce la massima profondità ammessa, floor(log_1.5(mNumero))
+int alberoC_impl_profonditaMassima(size_t mNumero)
+{
+    double potenza = 1.5;
+    int risultato = 0;
+
+    for(; potenza <= mNumero; potenza *= 1.5) ++risultato;
+    return risultato;
+}
+
+// Solo per gli scrittori, con il mutex bloccato
+size_t alberoC_impl_dimensione(const AlberoCNodo* mN)
+{
+    return mN == NULL ? 0
+                      : 1 + alberoC_impl_dimensione(mN->sx) +
+                            alberoC_impl_dimensione(mN->dx);
+}
+
+// Numero di livelli del sottoalbero di mN (solo per gli scrittori)
+int alberoC_impl_altezza(const AlberoCNodo* mN)
+{
+    int sx, dx;
+
+    if(mN == NULL) return 0;
+
+    sx = alberoC_impl_altezza(mN->sx);
+    dx = alberoC_impl_altezza(mN->dx);
+    return 1 + (sx > dx ? sx : dx);
+}
+
+// Collega i nodi mNodi[mInizio, mFine), in ordine, in un albero
+// perfettamente bilanciato e ne restituisce la radice
+AlberoCNodo* alberoC_impl_collega(
+    AlberoCNodo** mNodi, size_t mInizio, size_t mFine)
+{
+    size_t centro;
+
+    if(mInizio == mFine) return NULL;
+
+    centro = mInizio + (mFine - mInizio) / 2;
+    mNodi[centro]->sx = alberoC_impl_collega(mNodi, mInizio, centro);
+    mNodi[centro]->dx = alberoC_impl_collega(mNodi, centro + 1, mFine);
+    return mNodi[centro];
+}
+
+// Sostituisce il sottoalbero di *mLink, di mNumero nodi, con una sua copia
+// perfettamente bilanciata, e ritira i vecchi nodi
+// Restituisce 1 in caso di errore (l'albero resta invariato)
+int alberoC_impl_ricostruisci(
+    AlberoC* mA, AlberoCParte* mP, AlberoCNodo** mLink, size_t mNumero)
+{
+    AlberoCNodo* pila[ALBEROC_MAX_PROFONDITA];
+    AlberoCNodo** vecchi;
+    AlberoCNodo** nuovi;
+    AlberoCNodo* n = *mLink;
+    size_t i, k = 0;
+    int cima = 0;
+
+    if(mNumero == 0) return 0;
+
+    vecchi = malloc(2 * mNumero * sizeof(AlberoCNodo*));
+    if(vecchi == NULL || alberoC_impl_riserva(mP, mNumero) != 0)
+    {
+        free(vecchi);
+        return 1;
+    }
+    nuovi = vecchi + mNumero;
+
+    for(i = 0; i < mNumero; ++i)
+        if((nuovi[i] = malloc(sizeof(AlberoCNodo))) == NULL)
+        {
+            while(i > 0) free(nuovi[--i]);
+            free(vecchi);
+            return 1;
+        }
+
+    // Visita in ordine, con una pila: i nodi pubblicati non si modificano
+    while(n != NULL || cima > 0)
+    {
+        for(; n != NULL; n = n->sx)
+        {
+            assert(cima < ALBEROC_MAX_PROFONDITA);
+            pila[cima++] = n;
+        }
+
+        n = pila[--cima];
+        nuovi[k]->dato = n->dato;
+        vecchi[k++] = n;
+        n = n->dx;
+    }
+
+    assert(k == mNumero);
+    alberoC_impl_pubblica(mLink, alberoC_impl_collega(nuovi, 0, mNumero));
+
+    alberoC_impl_ritira(mA, mP, vecchi, mNumero);
+    free(vecchi);
+    return 0;
+}
+
+// Il nodo appena inserito in *mPercorso[mProfondita] è troppo profondo:
+// cerca l'antenato da ricostruire risalendo mPercorso, dove mPercorso[i] è
+// il link al nodo a profondità i
+// Restituisce 1 in caso di errore
+int alberoC_impl_ribilancia(AlberoC* mA, AlberoCParte* mP,
+    AlberoCNodo*** mPercorso, int mProfondita)
+{
+    size_t dimensione = 1, dimensioneFiglio;
+    int i;
+
+    for(i = mProfondita - 1; i >= 0; --i)
+    {
+        AlberoCNodo* antenato = *mPercorso[i];
+        AlberoCNodo* fratello =
+            mPercorso[i + 1] == &antenato->sx ? antenato->dx : antenato->sx;
+
+        dimensioneFiglio = dimensione;
+        dimensione =
+            1 + dimensioneFiglio + alberoC_impl_dimensione(fratello);
+
+        if(3 * dimensioneFiglio > 2 * dimensione)
+            return alberoC_impl_ricostruisci(
+                mA, mP, mPercorso[i], dimensione);
+    }
+
+    return 0;
+}
+
+// Restituisce 1 se mDato è presente
+// Non usa lock e non scrive memoria condivisa
+int alberoC_Ricerca(AlberoC* mA, int mDato)
+{
+    AlberoCNodo* n = alberoC_impl_leggi(&alberoC_impl_parte(mA, mDato)->radice);
+
+    while(n != NULL && n->dato != mDato)
+        n = alberoC_impl_leggi(mDato < n->dato ? &n->sx : &n->dx);
+
+    return n != NULL;
+}
+
+// Inserisce mDato
+// Restituisce 1 in caso di errore o se il dato è già presente
+int alberoC_Inserisci(AlberoC* mA, int mThread, int mDato)
+{
+    AlberoCParte* p = alberoC_impl_parte(mA, mDato);
+    AlberoCNodo** percorso[ALBEROC_MAX_PROFONDITA];
+    AlberoCNodo* nodo;
+    int profondita = 0, risultato = 1;
+
+    // Chi scrive non ha riferimenti a nodi fuori dal mutex: durante
+    // l'attesa del mutex il thread è quiescente, quindi non blocca le
+    // rimozioni degli altri scrittori
+    alberoC_Deregistra(mA, mThread);
+    pthread_mutex_lock(&p->mutex);
+
+    percorso[0] = &p->radice;
+    while((nodo = *percorso[profondita]) != NULL && nodo->dato != mDato)
+    {
+        assert(profondita + 1 < ALBEROC_MAX_PROFONDITA);
+        percorso[++profondita] = mDato < nodo->dato ? &nodo->sx : &nodo->dx;
+    }
+
+    if(nodo == NULL && (nodo = malloc(sizeof(AlberoCNodo))) != NULL)
+    {
+        nodo->sx = nodo->dx = NULL;
+        nodo->dato = mDato;
+        alberoC_impl_pubblica(percorso[profondita], nodo);
+
+        if(++p->numero > p->massimo) p->massimo = p->numero;
+        risultato = 0;
+
+        // Se la ricostruzione non riesce il nodo viene tolto di nuovo, così
+        // la profondità resta limitata
+        if(profondita > alberoC_impl_profonditaMassima(p->numero) &&
+            alberoC_impl_ribilancia(mA, p, percorso, profondita) != 0)
+        {
+            alberoC_impl_pubblica(percorso[profondita], NULL);
+            alberoC_impl_ritira(mA, p, &nodo, 1);
+            --p->numero;
+            risultato = 1;
+        }
+    }
+
+    pthread_mutex_unlock(&p->mutex);
+    alberoC_Registra(mA, mThread);
+    return risultato;
+}
+
+// Rimuove mDato
+// Restituisce 1 in caso di errore o se il dato non è presente
+int alberoC_Rimuovi(AlberoC* mA, int mThread, int mDato)
+{
+    AlberoCParte* p = alberoC_impl_parte(mA, mDato);
+    AlberoCNodo** link = &p->radice;
+    AlberoCNodo* nodo;
+    int risultato = 1, rimosso = 0;
+
+    alberoC_Deregistra(mA, mThread);
+    pthread_mutex_lock(&p->mutex);
+
+    while(*link != NULL && (*link)->dato != mDato)
+        link = mDato < (*link)->dato ? &(*link)->sx : &(*link)->dx;
+
+    nodo = *link;
+
+    if(nodo != NULL && (nodo->sx == NULL || nodo->dx == NULL))
+    {
+        // Al più un figlio: il figlio prende il posto del nodo
+        alberoC_impl_pubblica(link, nodo->sx != NULL ? nodo->sx : nodo->dx);
+        risultato = alberoC_impl_ritira(mA, p, &nodo, 1);
+        rimosso = 1;
+    }
+    else if(nodo != NULL)
+    {
+        // Due figli: il nodo viene sostituito da una sua copia con il dato
+        // del successore, ed il cammino da nodo->dx al padre del successore
+        // da copie che non contengono il successore. Il nuovo sottoalbero
+        // viene pubblicato con un'unica scrittura: un lettore vede tutto il
+        // sottoalbero vecchio o tutto quello nuovo, mai un successore
+        // scollegato mentre lo sta cercando più in basso
+        AlberoCNodo* succ = nodo->dx;
+        AlberoCNodo* copia = malloc(sizeof(AlberoCNodo));
+        AlberoCNodo** fine;
+        AlberoCNodo* n;
+
+        while(succ->sx != NULL) succ = succ->sx;
+
+        if(copia != NULL)
+        {
+            copia->sx = nodo->sx;
+            copia->dato = succ->dato;
+            fine = &copia->dx;
+
+            for(n = nodo->dx; n != succ; n = n->sx)
+            {
+                AlberoCNodo* c = malloc(sizeof(AlberoCNodo));
+
+                *fine = c;
+                if(c == NULL) break;
+
+                c->dx = n->dx;
+                c->dato = n->dato;
+                fine = &c->sx;
+            }
+
+            if(n != succ)
+            {
+                // Nulla è stato pubblicato: si deallocano le copie
+                n = copia->dx;
+                free(copia);
+                while(n != NULL)
+                {
+                    copia = n->sx;
+                    free(n);
+                    n = copia;
+                }
+            }
+            else
+            {
+                AlberoCNodo* prossimo = nodo->dx;
+
+                *fine = succ->dx;
+                alberoC_impl_pubblica(link, copia);
+
+                // Il figlio di un nodo va letto prima di ritirarlo, perchè
+                // alberoC_impl_ritira può deallocarlo subito
+                risultato = alberoC_impl_ritira(mA, p, &nodo, 1);
+                while(prossimo != succ)
+                {
+                    n = prossimo;
+                    prossimo = n->sx;
+                    risultato |= alberoC_impl_ritira(mA, p, &n, 1);
+                }
+                risultato |= alberoC_impl_ritira(mA, p, &succ, 1);
+                rimosso = 1;
+            }
+        }
+    }
+
+    if(rimosso)
+    {
+        // Dopo molte rimozioni i nodi rimasti sono troppo pochi per la
+        // profondità dell'albero: lo si ricostruisce tutto (se non riesce
+        // si riproverà alla prossima rimozione)
+        --p->numero;
+        if(3 * p->numero < 2 * p->massimo &&
+            alberoC_impl_ricostruisci(mA, p, &p->radice, p->numero) == 0)
+            p->massimo = p->numero;
+    }
+
+    pthread_mutex_unlock(&p->mutex);
+    alberoC_Registra(mA, mThread);
+    return risultato;
+}
+
+// Visita in ordine
+// Le partizioni non sono ordinate tra loro: ogni partizione viene visitata
+// in ordine con la propria pila, e le visite vengono fuse scegliendo ogni
+// volta, con un heap sulle partizioni, il minore dei dati in cima alle pile.
+
+typedef struct
+{
+    AlberoCNodo* pila[ALBEROC_MAX_PROFONDITA];
+    int cima;
+} AlberoCVisita;
+
+// Mette sulla pila il cammino verso il minore dato >= mMin del sottoalbero
+// di mN: i nodi con dato >= mMin che restano da visitare, insieme al loro
+// sottoalbero dx
+void alberoC_impl_scendi(AlberoCVisita* mV, AlberoCNodo* mN, int mMin)
+{
+    while(mN != NULL)
+    {
+        if(mN->dato < mMin)
+            mN = alberoC_impl_leggi(&mN->dx);
+        else
+        {
+            assert(mV->cima < ALBEROC_MAX_PROFONDITA);
+            mV->pila[mV->cima++] = mN;
+            mN = alberoC_impl_leggi(&mN->sx);
+        }
+    }
+}
+
+int alberoC_impl_primo(const AlberoCVisita* mV)
+{
+    return mV->pila[mV->cima - 1]->dato;
+}
+
+// Riporta in basso l'elemento mI dell'heap mHeap di mNumero partizioni
+void alberoC_impl_heapGiu(
+    const AlberoCVisita* mVisite, int* mHeap, int mNumero, int mI)
+{
+    int x = mHeap[mI], figlio;
+
+    while((figlio = 2 * mI + 1) < mNumero)
+    {
+        if(figlio + 1 < mNumero &&
+            alberoC_impl_primo(&mVisite[mHeap[figlio + 1]]) <
+                alberoC_impl_primo(&mVisite[mHeap[figlio]]))
+            ++figlio;
+        if(alberoC_impl_primo(&mVisite[x]) <=
+            alberoC_impl_primo(&mVisite[mHeap[figlio]]))
+            break;
+
+        mHeap[mI] = mHeap[figlio];
+        mI = figlio;
+    }
+
+    mHeap[mI] = x;
+}
+
+// Chiama mFunzione, in ordine crescente, su ogni dato in [mMin, mMax]
+// Come alberoC_Ricerca non usa lock: il thread deve essere registrato e non
+// chiamare alberoC_Quiescente durante la visita. I dati inseriti o rimossi
+// durante la visita possono essere visti o meno; un dato inserito in una
+// partizione rimasta indietro può essere minore dell'ultimo già visitato,
+// e viene saltato perchè la visita resti in ordine.
+void alberoC_VisitaIntervallo(AlberoC* mA, int mMin, int mMax,
+    void (*mFunzione)(int, void*), void* mDati)
+{
+    AlberoCVisita visite[ALBEROC_PARTI];
+    int heap[ALBEROC_PARTI];
+    int i, numero = 0, ultimo = 0, visitati = 0;
+
+    for(i = 0; i < ALBEROC_PARTI; ++i)
+    {
+        visite[i].cima = 0;
+        alberoC_impl_scendi(
+            &visite[i], alberoC_impl_leggi(&mA->parti[i].radice), mMin);
+        if(visite[i].cima > 0) heap[numero++] = i;
+    }
+
+    for(i = numero / 2 - 1; i >= 0; --i)
+        alberoC_impl_heapGiu(visite, heap, numero, i);
+
+    while(numero > 0 && alberoC_impl_primo(&visite[heap[0]]) <= mMax)
+    {
+        AlberoCVisita* v = &visite[heap[0]];
+        AlberoCNodo* n = v->pila[--v->cima];
+
+        if(!visitati || n->dato > ultimo)
+        {
+            (*mFunzione)(n->dato, mDati);
+            ultimo = n->dato;
+            visitati = 1;
+        }
+
+        alberoC_impl_scendi(v, alberoC_impl_leggi(&n->dx), mMin);
+
+        if(v->cima == 0) heap[0] = heap[--numero];
+        if(numero > 0) alberoC_impl_heapGiu(visite, heap, numero, 0);
+    }
+}
+
+// Benchmark
+// Ogni thread esegue lo stesso numero di operazioni su dati casuali in
+// [0, BENCH_DATI): BENCH_SCRITTURE per mille sono inserimenti o rimozioni,
+// le altre ricerche. Viene confrontato con lo stesso albero protetto da un
+// unico mutex globale.
+
+#define BENCH_DATI 1000000
+#define BENCH_ORDINATI 200000
+#define BENCH_OPERAZIONI 200000
+#define BENCH_SCRITTURE 100
+
+typedef struct
+{
+    AlberoC* albero;
+    pthread_mutex_t* mutexGlobale; // NULL per l'albero concorrente
+    int thread;
+    long trovati;
+} BenchTask;
+
+void stampaDato(int mDato, void* mDati)
+{
+    (void)mDati;
+    printf(" %d", mDato);
+}
+
+// Conta i dati visitati e verifica che siano in ordine crescente
+typedef struct
+{
+    long numero;
+    int ultimo, ordinati;
+} Conteggio;
+
+void contaDato(int mDato, void* mDati)
+{
+    Conteggio* c = (Conteggio*)mDati;
+
+    if(c->numero++ > 0 && mDato <= c->ultimo) c->ordinati = 0;
+    c->ultimo = mDato;
+}
+
+unsigned int benchCasuale(unsigned int* mStato)
+{
+    *mStato ^= *mStato << 13;
+    *mStato ^= *mStato >> 17;
+    *mStato ^= *mStato << 5;
+    return *mStato;
+}
+
+void* benchRun(void* mTask)
+{
+    BenchTask* task = (BenchTask*)mTask;
+    unsigned int stato = 2463534242u + task->thread * 7919u;
+    int i;
+
+    alberoC_Registra(task->albero, task->thread);
+
+    for(i = 0; i < BENCH_OPERAZIONI; ++i)
+    {
+        unsigned int r = benchCasuale(&stato);
+        int dato = (int)((r >> 10) % BENCH_DATI);
+        int tipo = r % 1000;
+
+        // Con il mutex globale non ci sono letture concorrenti: il thread
+        // resta quiescente mentre aspetta il mutex, come gli scrittori
+        if(task->mutexGlobale != NULL)
+        {
+            alberoC_Deregistra(task->albero, task->thread);
+            pthread_mutex_lock(task->mutexGlobale);
+        }
+
+        if(tipo >= BENCH_SCRITTURE)
+            task->trovati += alberoC_Ricerca(task->albero, dato);
+        else if(tipo % 2 == 0)
+            alberoC_Inserisci(task->albero, task->thread, dato);
+        else
+            alberoC_Rimuovi(task->albero, task->thread, dato);
+
+        if(task->mutexGlobale != NULL)
+        {
+            pthread_mutex_unlock(task->mutexGlobale);
+            alberoC_Registra(task->albero, task->thread);
+        }
+
+        alberoC_Quiescente(task->albero, task->thread);
+    }
+
+    alberoC_Deregistra(task->albero, task->thread);
+    return NULL;
+}
+
+// Restituisce i milioni di operazioni al secondo
+double bench(AlberoC* mA, pthread_mutex_t* mMutexGlobale, int mThreadCount)
+{
+    pthread_t threads[ALBEROC_MAX_THREADS];
+    int started[ALBEROC_MAX_THREADS];
+    BenchTask tasks[ALBEROC_MAX_THREADS];
+    struct timespec inizio, fine;
+    int t;
+
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+
+    for(t = 0; t < mThreadCount; ++t)
+    {
+        tasks[t].albero = mA;
+        tasks[t].mutexGlobale = mMutexGlobale;
+        tasks[t].thread = t;
+        tasks[t].trovati = 0;
+
+        started[t] =
+            pthread_create(&threads[t], NULL, &benchRun, &tasks[t]) == 0;
+        if(!started[t]) benchRun(&tasks[t]);
+    }
+
+    for(t = 0; t < mThreadCount; ++t)
+        if(started[t]) pthread_join(threads[t], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &fine);
+
+    return (double)mThreadCount * BENCH_OPERAZIONI /
+           ((fine.tv_sec - inizio.tv_sec) * 1e3 +
+               (fine.tv_nsec - inizio.tv_nsec) / 1e6) / 1e3;
+}
+
+int main()
+{
+    AlberoC a;
+    pthread_mutex_t mutexGlobale;
+    unsigned int stato = 12345;
+    int i, threads, usate;
+
+    if(alberoC_Crea(&a) != 0) return 1;
+    pthread_mutex_init(&mutexGlobale, NULL);
+
+    alberoC_Registra(&a, 0);
+
+    alberoC_Inserisci(&a, 0, 5);
+    alberoC_Inserisci(&a, 0, -3);
+    alberoC_Inserisci(&a, 0, 8);
+    alberoC_Inserisci(&a, 0, 7);
+    alberoC_Inserisci(&a, 0, 9);
+    alberoC_Rimuovi(&a, 0, 8);
+
+    printf("Ricerca di -3: %d\n", alberoC_Ricerca(&a, -3));
+    printf("Ricerca di 8: %d\n", alberoC_Ricerca(&a, 8));
+    printf("Ricerca di 9: %d\n", alberoC_Ricerca(&a, 9));
+    printf("Visita in ordine:");
+    alberoC_VisitaIntervallo(&a, INT_MIN, INT_MAX, &stampaDato, NULL);
+    printf("\n");
+
+    {
+        // Dati in ordine crescente: senza bilanciamento ogni partizione
+        // diventerebbe una lista
+        AlberoC ordinato;
+        struct timespec inizio, fine;
+        int altezza = 0;
+
+        if(alberoC_Crea(&ordinato) != 0) return 1;
+        alberoC_Registra(&ordinato, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &inizio);
+        for(i = 0; i < BENCH_ORDINATI; ++i) alberoC_Inserisci(&ordinato, 0, i);
+        clock_gettime(CLOCK_MONOTONIC, &fine);
+
+        for(i = 0; i < ALBEROC_PARTI; ++i)
+        {
+            int h = alberoC_impl_altezza(ordinato.parti[i].radice);
+            if(h > altezza) altezza = h;
+        }
+
+        printf("\n%d dati in ordine crescente: %f s, altezza massima %d\n",
+            BENCH_ORDINATI, (fine.tv_sec - inizio.tv_sec) +
+                                (fine.tv_nsec - inizio.tv_nsec) / 1e9,
+            altezza);
+
+        {
+            Conteggio tutti = {0, 0, 1}, intervallo = {0, 0, 1};
+
+            alberoC_VisitaIntervallo(
+                &ordinato, INT_MIN, INT_MAX, &contaDato, &tutti);
+            alberoC_VisitaIntervallo(
+                &ordinato, 1000, 1999, &contaDato, &intervallo);
+
+            printf("Visita in ordine: %ld dati (in ordine: %d), "
+                   "tra 1000 e 1999: %ld\n",
+                tutti.numero, tutti.ordinati, intervallo.numero);
+        }
+
+        alberoC_Deregistra(&ordinato, 0);
+        alberoC_Distruggi(&ordinato);
+    }
+
+    // Metà dei dati presenti all'inizio del benchmark
+    for(i = 0; i < BENCH_DATI / 2; ++i)
+        alberoC_Inserisci(
+            &a, 0, (int)((benchCasuale(&stato) >> 10) % BENCH_DATI));
+
+    alberoC_Deregistra(&a, 0);
+
+    for(i = usate = 0; i < ALBEROC_PARTI; ++i)
+        usate += a.parti[i].radice != NULL;
+    printf("\nPartizioni usate dai dati del benchmark: %d su %d\n", usate,
+        ALBEROC_PARTI);
+
+    printf("\n%d operazioni per thread, %d%% scritture\n", BENCH_OPERAZIONI,
+        BENCH_SCRITTURE / 10);
+    printf("Thread\tMop/s mutex globale\tMop/s concorrente\n");
+
+    for(threads = 1; threads <= ALBEROC_MAX_THREADS; threads *= 2)
+    {
+        double globale = bench(&a, &mutexGlobale, threads);
+        double concorrente = bench(&a, NULL, threads);
+
+        printf("%d\t%f\t\t%f\n", threads, globale, concorrente);
+    }
+
+    pthread_mutex_destroy(&mutexGlobale);
+    alberoC_Distruggi(&a);
+
+    return 0;
+}
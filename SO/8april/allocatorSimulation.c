@@ -0,0 +1,386 @@
+// Copyright (c) 2015 Vittorio Romeo
+// License: MIT License | http://opensource.org/licenses/MIT
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+// Event-driven version of the process simulation of second.py, for traces
+// of millions of processes.
+//
+// Instead of advancing one time unit at a time, the simulation jumps from
+// event to event: arrivals come from the trace sorted by start time,
+// departures from a min-heap ordered by end time. Memory is managed by a
+// VeeLib arena (Utils/Arena.h), so block headers and alignment count
+// towards the memory size. All the placement policies of second.py, and
+// the buddy allocator, run in parallel, one thread each, on the same trace.
+//
+// The semantics of second.py are kept:
+//      - in every time unit, processes are inserted before finished ones
+//        are removed, so memory freed at time t is available at t + 1;
+//      - a process that does not fit waits, and is retried (before new
+//        arrivals) at the time unit following every departure, when memory
+//        may have changed: failures count these attempts, not one attempt
+//        per time unit;
+//      - the average fragmentation is weighted by time: the fragmentation
+//        after each time unit, averaged over all of them.
+// Comparisons are the nodes visited by the arena trees, except for the
+// "naive" policies, which place blocks as the tree ones but are charged a
+// scan of all the blocks, as in second.py. Unlike second.py, worst-fit
+// (naive) really picks the largest block. Processes larger than the whole
+// memory are rejected instead of waiting forever.
+// The fragmentation above is external; internal fragmentation is the
+// fraction of the allocated blocks exceeding the requested sizes (headers,
+// alignment and, for the buddy allocator, rounding to powers of two).
+//
+// Build: gcc -std=c99 -O2 -fgnu89-inline -I../../VeeLib/include
+//        allocatorSimulation.c -o allocatorSimulation -lm -pthread
+//
+// Usage:
+//      allocatorSimulation generate <trace> <count> [seed]
+//      allocatorSimulation run <trace> [memory size]
+//
+// A trace is a text file with a line per process: start time, required
+// time and memory size.
+
+#define _POSIX_C_SOURCE 200112L
+#define VL_COUNT_OPS
+#define VL_COUNT_OPS_IMPL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <VeeLib/VeeLib.h>
+#include "trace.h"
+
+#define SIM_DEFAULT_MEMORY 10000
+
+// When more processes than this wait for memory, the policy cannot keep up
+// with the trace: the queue would keep growing, and every departure would
+// retry all of it, so the simulation stops
+#define SIM_MAX_WAITING 10000
+
+// Generated processes arrive every SIM_MAX_GAP / 2 time units on average,
+// to keep the memory busy but not full
+#define SIM_MAX_GAP 16
+
+// A departure: the process leaves at `time`, freeing `block`
+typedef struct
+{
+    long long time;
+    int process;
+    void* block;
+} Departure;
+
+// A simulation of a trace with a placement policy, run by its own thread
+typedef struct
+{
+    const char* name;
+    VlArenaPolicy policy;
+    bool naive;
+
+    const Trace* trace;
+    size_t memorySize;
+
+    unsigned long long comparisons, allocations, failures, rejected;
+    unsigned long long requestedBytes, blockBytes;
+    long long ticks, saturatedAt; // saturatedAt is -1 if never saturated
+    double avgFragmentation, seconds; // CPU time of the thread
+    int error;
+} Simulation;
+
+// Departure heap
+
+static bool departsBefore(const Departure* mA, const Departure* mB)
+{
+    return mA->time < mB->time ||
+           (mA->time == mB->time && mA->process < mB->process);
+}
+
+static void heapPush(Departure* mHeap, size_t* mSize, Departure mX)
+{
+    size_t i = (*mSize)++;
+
+    for(; i > 0 && departsBefore(&mX, &mHeap[(i - 1) / 2]); i = (i - 1) / 2)
+        mHeap[i] = mHeap[(i - 1) / 2];
+
+    mHeap[i] = mX;
+}
+
+static Departure heapPop(Departure* mHeap, size_t* mSize)
+{
+    Departure result = mHeap[0], last = mHeap[--*mSize];
+    size_t i = 0, child;
+
+    while((child = 2 * i + 1) < *mSize)
+    {
+        if(child + 1 < *mSize && departsBefore(&mHeap[child + 1], &mHeap[child]))
+            ++child;
+        if(!departsBefore(&mHeap[child], &last)) break;
+
+        mHeap[i] = mHeap[child];
+        i = child;
+    }
+
+    mHeap[i] = last;
+    return result;
+}
+
+// Tries to allocate memory for process mIdx, scheduling its departure
+static bool tryInsert(Simulation* mSim, VlArena* mArena, Departure* mHeap,
+    size_t* mHeapSize, long long mNow, int mIdx)
+{
+    const Process* p = &mSim->trace->processes[mIdx];
+    unsigned long long visits = vlops_get().visits;
+    size_t usedBytes = mArena->usedBytes;
+    Departure departure;
+
+    if(mSim->naive)
+        mSim->comparisons += mArena->usedBlocks + mArena->freeBlocks;
+
+    departure.block = vlarena_alloc(mArena, (size_t)p->size);
+
+    if(!mSim->naive) mSim->comparisons += vlops_get().visits - visits;
+
+    if(departure.block == NULL)
+    {
+        ++mSim->failures;
+        return false;
+    }
+
+    ++mSim->allocations;
+    mSim->requestedBytes += p->size;
+    mSim->blockBytes += mArena->usedBytes - usedBytes;
+    departure.time = mNow + p->required - 1;
+    departure.process = mIdx;
+    heapPush(mHeap, mHeapSize, departure);
+    return true;
+}
+
+static void* simulate(void* mSim)
+{
+    Simulation* sim = (Simulation*)mSim;
+    const Trace* trace = sim->trace;
+    double begin = now(CLOCK_THREAD_CPUTIME_ID), fragmentation = 0;
+    char* memory = (char*)malloc(sim->memorySize);
+    VlArena arena;
+
+    // Every running process holds at least a minimum size block
+    Departure* heap = (Departure*)malloc(
+        (sim->memorySize / VLARENA_MIN_BLOCK + 1) * sizeof(Departure));
+    size_t heapSize = 0;
+
+    // Processes waiting for memory, in arrival order
+    int* waiting = NULL;
+    size_t waitingSize = 0, waitingCapacity = 0;
+
+    size_t next = 0, capacity;
+    long long time = 0, retryTime = -1;
+
+    sim->error = memory == NULL || heap == NULL ||
+                 vlarena_init(&arena, memory, sim->memorySize, sim->policy) != 0;
+
+    if(sim->error)
+    {
+        free(memory);
+        free(heap);
+        return NULL;
+    }
+
+    capacity = vlarena_getLargestFree(&arena);
+    sim->saturatedAt = -1;
+    vlops_reset();
+
+    while((next < trace->count || heapSize > 0 || waitingSize > 0) &&
+          sim->saturatedAt == -1)
+    {
+        // Time of the next event
+        long long t = -1;
+        size_t i, kept;
+
+        if(next < trace->count) t = trace->processes[next].start;
+        if(heapSize > 0 && (t == -1 || heap[0].time < t)) t = heap[0].time;
+        if(retryTime != -1 && (t == -1 || retryTime < t)) t = retryTime;
+
+        if(t == -1)
+        {
+            // Memory is empty and nothing arrives: waiting processes never fit
+            sim->rejected += waitingSize;
+            break;
+        }
+
+        // The fragmentation after the last event held until now
+        fragmentation += (double)vlarena_getFragmentation(&arena) * (t - time);
+        time = t;
+
+        // Insertions: waiting processes first, then arrivals
+        if(retryTime == time)
+        {
+            retryTime = -1;
+
+            for(i = kept = 0; i < waitingSize; ++i)
+                if(!tryInsert(sim, &arena, heap, &heapSize, time, waiting[i]))
+                    waiting[kept++] = waiting[i];
+
+            waitingSize = kept;
+        }
+
+        for(; next < trace->count && trace->processes[next].start == time; ++next)
+        {
+            if((size_t)trace->processes[next].size > capacity)
+            {
+                ++sim->rejected;
+                continue;
+            }
+
+            if(tryInsert(sim, &arena, heap, &heapSize, time, (int)next)) continue;
+
+            if(waitingSize == waitingCapacity)
+            {
+                int* grown;
+
+                waitingCapacity = waitingCapacity * 2 + 64;
+                grown = (int*)realloc(waiting, waitingCapacity * sizeof(int));
+
+                if(grown == NULL)
+                {
+                    sim->error = 1;
+                    free(waiting);
+                    free(heap);
+                    free(memory);
+                    return NULL;
+                }
+
+                waiting = grown;
+            }
+
+            waiting[waitingSize++] = (int)next;
+
+            if(waitingSize > SIM_MAX_WAITING)
+            {
+                sim->saturatedAt = time;
+                break;
+            }
+        }
+
+        // Removals
+        while(heapSize > 0 && heap[0].time == time)
+        {
+            vlarena_free(&arena, heapPop(heap, &heapSize).block);
+            if(waitingSize > 0) retryTime = time + 1;
+        }
+    }
+
+    // The last time unit
+    fragmentation += (double)vlarena_getFragmentation(&arena);
+    sim->ticks = time + 1;
+    sim->avgFragmentation = fragmentation / sim->ticks;
+    sim->seconds = now(CLOCK_THREAD_CPUTIME_ID) - begin;
+
+    free(waiting);
+    free(heap);
+    free(memory);
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    Simulation sims[] = {
+        {.name = "first-fit", .policy = vlarena_FirstFit, .naive = false},
+        {.name = "next-fit", .policy = vlarena_NextFit, .naive = false},
+        {.name = "best-fit (naive)", .policy = vlarena_BestFit, .naive = true},
+        {.name = "worst-fit (naive)", .policy = vlarena_WorstFit, .naive = true},
+        {.name = "best-fit (tree)", .policy = vlarena_BestFit, .naive = false},
+        {.name = "worst-fit (tree)", .policy = vlarena_WorstFit, .naive = false},
+        {.name = "buddy", .policy = vlarena_Buddy, .naive = false}};
+    pthread_t threads[VL_GET_ARRAY_SIZE(sims)];
+    bool started[VL_GET_ARRAY_SIZE(sims)];
+    size_t memorySize = SIM_DEFAULT_MEMORY, s;
+    double begin;
+    Trace trace;
+
+    if(argc >= 4 && strcmp(argv[1], "generate") == 0)
+    {
+        long count = atol(argv[3]);
+        unsigned long long seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+
+        if(count < 0 || generateTrace(argv[2], count, seed, SIM_MAX_GAP) != 0)
+        {
+            fprintf(stderr, "Cannot write %s\n", argv[2]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if(argc < 3 || strcmp(argv[1], "run") != 0)
+    {
+        fprintf(stderr,
+            "Usage:\n\t%s generate <trace> <count> [seed]\n"
+            "\t%s run <trace> [memory size]\n",
+            argv[0], argv[0]);
+        return 1;
+    }
+
+    if(argc > 3) memorySize = (size_t)atol(argv[3]);
+
+    begin = now(CLOCK_MONOTONIC);
+    if(loadTrace(argv[2], &trace) != 0)
+    {
+        fprintf(stderr, "Cannot read a valid trace from %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%lu processes loaded in %.2fs, memory size %lu\n\n",
+        (unsigned long)trace.count, now(CLOCK_MONOTONIC) - begin,
+        (unsigned long)memorySize);
+
+    begin = now(CLOCK_MONOTONIC);
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+    {
+        sims[s].trace = &trace;
+        sims[s].memorySize = memorySize;
+        started[s] = pthread_create(&threads[s], NULL, &simulate, &sims[s]) == 0;
+
+        // Run it on this thread if it cannot have its own
+        if(!started[s]) simulate(&sims[s]);
+    }
+
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+        if(started[s]) pthread_join(threads[s], NULL);
+
+    printf("%-20s %16s %10s %10s %12s %9s %14s %8s\n", "policy",
+        "comparisons", "avg frag", "internal", "failures", "rejected", "score",
+        "cpu s");
+
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+    {
+        const Simulation* sim = &sims[s];
+
+        if(sim->error)
+        {
+            printf("%-20s out of memory\n", sim->name);
+            continue;
+        }
+
+        if(sim->saturatedAt != -1)
+        {
+            printf("%-20s saturated at time %lld\n", sim->name, sim->saturatedAt);
+            continue;
+        }
+
+        // Score as in second.py: lower is better
+        printf("%-20s %16llu %10.4f %9.2f%% %12llu %9llu %14.0f %8.2f\n",
+            sim->name, sim->comparisons, sim->avgFragmentation,
+            sim->blockBytes > 0
+                ? 100.0 * (sim->blockBytes - sim->requestedBytes) / sim->blockBytes
+                : 0.0,
+            sim->failures, sim->rejected,
+            sim->avgFragmentation * sim->comparisons / 100.0, sim->seconds);
+    }
+
+    printf("\n%lld time units simulated in %.2fs\n", sims[0].ticks,
+        now(CLOCK_MONOTONIC) - begin);
+
+    free(trace.processes);
+    return 0;
+}
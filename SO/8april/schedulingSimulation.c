@@ -0,0 +1,719 @@
+// Copyright (c) 2015 Vittorio Romeo
+// License: MIT License | http://opensource.org/licenses/MIT
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+// Event-driven CPU scheduling simulation, on the process model of
+// second.py: every process arrives at its start time and needs the CPU for
+// its required time (its memory size is ignored here).
+//
+// The simulation jumps from event to event. Events live in an indexed
+// min-heap, keyed by time, where every event source has a fixed slot that
+// can be rescheduled or cancelled in O(log n): one slot per CPU (the
+// running process completes, or its time slice ends), one for the next
+// arrival (the trace is sorted by start time) and one for the periodic
+// priority boost of MLFQ. All the events of a time unit are handled before
+// idle CPUs are given new processes: completions first, then arrivals.
+//
+// Policies are tables of functions over the ready processes:
+//      - FCFS: first come, first served;
+//      - SJF: shortest job first, not preemptive;
+//      - SRTF: shortest remaining time first, an arrival preempts the
+//        running process with the longest remaining time if it is shorter;
+//      - RR: round robin with a fixed quantum;
+//      - MLFQ: SCHED_MLFQ_LEVELS round robin queues, the quantum doubling
+//        at every level. Processes arrive in the first one, and move down
+//        after using their quantum at a level (across preemptions). An
+//        arrival preempts a process of a lower level. Every
+//        SCHED_BOOST_PERIOD time units every process, ready or running,
+//        goes back to the first level with a new quantum.
+// A process preempted or at the end of its quantum goes back to the end of
+// its queue. All the CPUs share the ready processes. Every policy runs in
+// parallel, one thread each, on the same trace.
+//
+// Metrics, over all the processes:
+//      - turnaround: completion time - arrival time;
+//      - waiting: turnaround - required time (time spent ready);
+//      - response: first time on a CPU - arrival time;
+//      - context switches: times a CPU starts a process other than the
+//        one it ran last.
+//
+// Build: gcc -std=c99 -O2 -fgnu89-inline -I../../VeeLib/include
+//        schedulingSimulation.c -o schedulingSimulation -lm -pthread
+//
+// Usage:
+//      schedulingSimulation generate <trace> <count> [seed]
+//      schedulingSimulation run <trace> [cpus] [quantum]
+//
+// A trace is a text file with a line per process: start time, required
+// time and memory size, as the traces of allocatorSimulation. The
+// generated ones keep one CPU about 90% busy; the denser traces of
+// allocatorSimulation need at least 3 CPUs to keep up.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <VeeLib/VeeLib.h>
+#include "trace.h"
+
+#define SCHED_DEFAULT_CPUS 1
+#define SCHED_MAX_CPUS 64
+#define SCHED_DEFAULT_QUANTUM 8
+
+#define SCHED_MLFQ_LEVELS 3
+#define SCHED_BOOST_PERIOD 1000
+
+// Generated processes arrive every SCHED_MAX_GAP / 2 time units on average
+#define SCHED_MAX_GAP 48
+
+// Indexed min-heap of events: event `id` is scheduled at `time[id]`, and
+// is at `heap[position[id]]` (position is -1 if it is not scheduled)
+typedef struct
+{
+    int heap[SCHED_MAX_CPUS + 2];
+    int position[SCHED_MAX_CPUS + 2];
+    long long time[SCHED_MAX_CPUS + 2];
+    int size;
+} EventQueue;
+
+// Ready processes in arrival order: the first `head` ones have left
+typedef struct
+{
+    VlVectorI items;
+    size_t head;
+} Fifo;
+
+typedef struct Simulation Simulation;
+
+// A scheduling policy. `preempts`, `ran` and `boost` can be NULL
+typedef struct
+{
+    // Makes process mP ready: it arrived, or it left a CPU unfinished
+    // Returns 1 in case of error (out of memory)
+    int (*ready)(Simulation* mSim, int mP);
+
+    // Removes and returns the next process to run, -1 if there is none
+    int (*next)(Simulation* mSim);
+
+    // Longest time mP can run before it is stopped
+    long long (*slice)(const Simulation* mSim, int mP);
+
+    // Whether process mP, with mPRemaining time units to go, must take the
+    // CPU from mRunning, which has mRemaining to go
+    bool (*preempts)(const Simulation* mSim, int mP, int mPRemaining,
+        int mRunning, int mRemaining);
+
+    // Process mP left a CPU after running mTime time units
+    void (*ran)(Simulation* mSim, int mP, int mTime);
+
+    // Periodic priority boost at mTime, which can reschedule the ends of
+    // the slices in mEvents
+    // Returns 1 in case of error (out of memory)
+    int (*boost)(Simulation* mSim, EventQueue* mEvents, long long mTime);
+} Policy;
+
+// A simulation of a trace with a scheduling policy, run by its own thread
+struct Simulation
+{
+    const char* name;
+    const Policy* policy;
+
+    const Trace* trace;
+    int cpus, quantum;
+
+    // State of every process
+    int* remaining;
+    unsigned char* started;
+    unsigned char* level; // MLFQ only
+    int* used;            // MLFQ only: time used at the current level
+
+    // Ready processes: `heap` for SJF and SRTF, `fifos[0]` for FCFS and RR,
+    // one FIFO per level for MLFQ
+    VlVectorI heap;
+    Fifo fifos[SCHED_MLFQ_LEVELS];
+
+    // State of every CPU
+    int running[SCHED_MAX_CPUS], lastRun[SCHED_MAX_CPUS];
+    long long dispatchTime[SCHED_MAX_CPUS];
+
+    double turnaround, waiting, response; // Sums
+    long long maxWaiting, maxResponse, endTime;
+    unsigned long long contextSwitches, preemptions, completed;
+    double seconds; // CPU time of the thread
+    int error;
+};
+
+// Event queue
+
+static bool eventBefore(const EventQueue* mQ, int mA, int mB)
+{
+    return mQ->time[mA] < mQ->time[mB] ||
+           (mQ->time[mA] == mQ->time[mB] && mA < mB);
+}
+
+static void eventPlace(EventQueue* mQ, int mI, int mId)
+{
+    mQ->heap[mI] = mId;
+    mQ->position[mId] = mI;
+}
+
+// Moves the event at mI to its place
+static void eventSift(EventQueue* mQ, int mI)
+{
+    int id = mQ->heap[mI], child;
+
+    for(; mI > 0 && eventBefore(mQ, id, mQ->heap[(mI - 1) / 2]);
+        mI = (mI - 1) / 2)
+        eventPlace(mQ, mI, mQ->heap[(mI - 1) / 2]);
+
+    while((child = 2 * mI + 1) < mQ->size)
+    {
+        if(child + 1 < mQ->size &&
+            eventBefore(mQ, mQ->heap[child + 1], mQ->heap[child]))
+            ++child;
+        if(!eventBefore(mQ, mQ->heap[child], id)) break;
+
+        eventPlace(mQ, mI, mQ->heap[child]);
+        mI = child;
+    }
+
+    eventPlace(mQ, mI, id);
+}
+
+static void eventInit(EventQueue* mQ, int mIds)
+{
+    int i;
+
+    mQ->size = 0;
+    for(i = 0; i < mIds; ++i) mQ->position[i] = -1;
+}
+
+// Schedules (or reschedules) event mId at mTime
+static void eventSet(EventQueue* mQ, int mId, long long mTime)
+{
+    mQ->time[mId] = mTime;
+    if(mQ->position[mId] == -1) eventPlace(mQ, mQ->size++, mId);
+    eventSift(mQ, mQ->position[mId]);
+}
+
+static void eventCancel(EventQueue* mQ, int mId)
+{
+    int i = mQ->position[mId];
+
+    if(i == -1) return;
+
+    mQ->position[mId] = -1;
+    if(i == --mQ->size) return;
+
+    eventPlace(mQ, i, mQ->heap[mQ->size]);
+    eventSift(mQ, i);
+}
+
+// Ready queues
+
+// Returns 1 in case of error
+static int fifoPush(Fifo* mF, int mP) { return vlv_pushI(&mF->items, mP); }
+
+static int fifoPop(Fifo* mF)
+{
+    int result;
+
+    if(mF->head == mF->items.size) return -1;
+
+    result = mF->items.data[mF->head++];
+
+    // Drop the elements that left once they are half of the vector
+    if(mF->head == mF->items.size)
+    {
+        vlv_clearI(&mF->items);
+        mF->head = 0;
+    }
+    else if(mF->head * 2 >= mF->items.size)
+    {
+        mF->items.size -= mF->head;
+        memmove(mF->items.data, mF->items.data + mF->head,
+            mF->items.size * sizeof(int));
+        mF->head = 0;
+    }
+
+    return result;
+}
+
+// Order of the SJF and SRTF heap: shortest remaining time, then arrival
+static bool shorter(const Simulation* mSim, int mA, int mB)
+{
+    return mSim->remaining[mA] < mSim->remaining[mB] ||
+           (mSim->remaining[mA] == mSim->remaining[mB] && mA < mB);
+}
+
+static int heapReady(Simulation* mSim, int mP)
+{
+    VlVectorI* heap = &mSim->heap;
+    size_t i = heap->size;
+
+    if(vlv_pushI(heap, mP) != 0) return 1;
+
+    for(; i > 0 && shorter(mSim, mP, heap->data[(i - 1) / 2]); i = (i - 1) / 2)
+        heap->data[i] = heap->data[(i - 1) / 2];
+
+    heap->data[i] = mP;
+    return 0;
+}
+
+static int heapNext(Simulation* mSim)
+{
+    VlVectorI* heap = &mSim->heap;
+    size_t i = 0, child;
+    int result, last;
+
+    if(heap->size == 0) return -1;
+
+    result = heap->data[0];
+    last = heap->data[--heap->size];
+
+    while((child = 2 * i + 1) < heap->size)
+    {
+        if(child + 1 < heap->size &&
+            shorter(mSim, heap->data[child + 1], heap->data[child]))
+            ++child;
+        if(!shorter(mSim, heap->data[child], last)) break;
+
+        heap->data[i] = heap->data[child];
+        i = child;
+    }
+
+    heap->data[i] = last;
+    return result;
+}
+
+// Policies
+
+static long long untilDone(const Simulation* mSim, int mP)
+{
+    (void)mSim;
+    (void)mP;
+    return -1;
+}
+
+static long long quantum(const Simulation* mSim, int mP)
+{
+    (void)mP;
+    return mSim->quantum;
+}
+
+static int fifoReady(Simulation* mSim, int mP)
+{
+    return fifoPush(&mSim->fifos[0], mP);
+}
+
+static int fifoNext(Simulation* mSim) { return fifoPop(&mSim->fifos[0]); }
+
+static bool srtfPreempts(const Simulation* mSim, int mP, int mPRemaining,
+    int mRunning, int mRemaining)
+{
+    (void)mSim;
+    (void)mP;
+    (void)mRunning;
+    return mPRemaining < mRemaining;
+}
+
+static int mlfqReady(Simulation* mSim, int mP)
+{
+    return fifoPush(&mSim->fifos[mSim->level[mP]], mP);
+}
+
+static int mlfqNext(Simulation* mSim)
+{
+    int level, result = -1;
+
+    for(level = 0; level < SCHED_MLFQ_LEVELS && result == -1; ++level)
+        result = fifoPop(&mSim->fifos[level]);
+
+    return result;
+}
+
+static long long mlfqSlice(const Simulation* mSim, int mP)
+{
+    return ((long long)mSim->quantum << mSim->level[mP]) - mSim->used[mP];
+}
+
+static bool mlfqPreempts(const Simulation* mSim, int mP, int mPRemaining,
+    int mRunning, int mRemaining)
+{
+    (void)mPRemaining;
+    (void)mRemaining;
+    return mSim->level[mP] < mSim->level[mRunning];
+}
+
+static void mlfqRan(Simulation* mSim, int mP, int mTime)
+{
+    mSim->used[mP] += mTime;
+
+    if(mSim->used[mP] < mSim->quantum << mSim->level[mP]) return;
+
+    mSim->used[mP] = 0;
+    if(mSim->level[mP] < SCHED_MLFQ_LEVELS - 1) ++mSim->level[mP];
+}
+
+static int mlfqBoost(Simulation* mSim, EventQueue* mEvents, long long mTime)
+{
+    Fifo* first = &mSim->fifos[0];
+    int level, c;
+
+    // A running process starts its quantum at the first level now: the
+    // time it already ran is taken out of `used` in advance, since mlfqRan
+    // adds the whole run when it stops, and its slice ends a quantum from
+    // now (or when it completes)
+    for(c = 0; c < mSim->cpus; ++c)
+    {
+        int p = mSim->running[c], ran;
+        long long slice = mSim->quantum;
+
+        if(p == -1) continue;
+
+        ran = (int)(mTime - mSim->dispatchTime[c]);
+        mSim->level[p] = 0;
+        mSim->used[p] = -ran;
+
+        if(slice > mSim->remaining[p] - ran) slice = mSim->remaining[p] - ran;
+        eventSet(mEvents, c, mTime + slice);
+    }
+
+    for(level = 1; level < SCHED_MLFQ_LEVELS; ++level)
+    {
+        Fifo* fifo = &mSim->fifos[level];
+        size_t i;
+
+        for(i = fifo->head; i < fifo->items.size; ++i)
+        {
+            mSim->level[fifo->items.data[i]] = 0;
+            mSim->used[fifo->items.data[i]] = 0;
+        }
+
+        if(vlv_appendI(&first->items, fifo->items.data + fifo->head,
+               fifo->items.size - fifo->head) != 0)
+            return 1;
+
+        vlv_clearI(&fifo->items);
+        fifo->head = 0;
+    }
+
+    return 0;
+}
+
+static const Policy fcfs = {fifoReady, fifoNext, untilDone, NULL, NULL, NULL};
+static const Policy sjf = {heapReady, heapNext, untilDone, NULL, NULL, NULL};
+static const Policy srtf = {
+    heapReady, heapNext, untilDone, srtfPreempts, NULL, NULL};
+static const Policy rr = {fifoReady, fifoNext, quantum, NULL, NULL, NULL};
+static const Policy mlfq = {
+    mlfqReady, mlfqNext, mlfqSlice, mlfqPreempts, mlfqRan, mlfqBoost};
+
+// Simulation
+
+// Takes the process running on mCpu off it at mTime, and returns it
+static int stop(
+    Simulation* mSim, EventQueue* mEvents, int mCpu, long long mTime)
+{
+    int p = mSim->running[mCpu];
+    int ran = (int)(mTime - mSim->dispatchTime[mCpu]);
+
+    mSim->remaining[p] -= ran;
+    if(mSim->policy->ran != NULL) mSim->policy->ran(mSim, p, ran);
+
+    mSim->running[mCpu] = -1;
+    eventCancel(mEvents, mCpu);
+    return p;
+}
+
+static void complete(Simulation* mSim, int mP, long long mTime)
+{
+    const Process* process = &mSim->trace->processes[mP];
+    long long turnaround = mTime - process->start;
+    long long waiting = turnaround - process->required;
+
+    mSim->turnaround += (double)turnaround;
+    mSim->waiting += (double)waiting;
+    if(waiting > mSim->maxWaiting) mSim->maxWaiting = waiting;
+    ++mSim->completed;
+    mSim->endTime = mTime;
+}
+
+static void dispatch(Simulation* mSim, EventQueue* mEvents, int mCpu, int mP,
+    long long mTime)
+{
+    long long slice = mSim->policy->slice(mSim, mP);
+
+    if(!mSim->started[mP])
+    {
+        long long response = mTime - mSim->trace->processes[mP].start;
+
+        mSim->started[mP] = 1;
+        mSim->response += (double)response;
+        if(response > mSim->maxResponse) mSim->maxResponse = response;
+    }
+
+    if(mSim->lastRun[mCpu] != -1 && mSim->lastRun[mCpu] != mP)
+        ++mSim->contextSwitches;
+
+    mSim->running[mCpu] = mSim->lastRun[mCpu] = mP;
+    mSim->dispatchTime[mCpu] = mTime;
+
+    if(slice < 0 || slice > mSim->remaining[mP]) slice = mSim->remaining[mP];
+    eventSet(mEvents, mCpu, mTime + slice);
+}
+
+// Makes process mP ready at mTime, taking a CPU for it if the policy says
+// so. Returns 1 in case of error
+static int arrive(
+    Simulation* mSim, EventQueue* mEvents, int mP, long long mTime)
+{
+    const Policy* policy = mSim->policy;
+    int c, victim = -1, victimRemaining = 0;
+
+    if(policy->preempts != NULL)
+        for(c = 0; c < mSim->cpus; ++c)
+        {
+            int running = mSim->running[c];
+            int remaining;
+
+            // An idle CPU will take the process anyway
+            if(running == -1) return policy->ready(mSim, mP);
+
+            remaining = mSim->remaining[running] -
+                        (int)(mTime - mSim->dispatchTime[c]);
+
+            // The process with the lowest priority is preempted
+            if(victim == -1 ? policy->preempts(mSim, mP, mSim->remaining[mP],
+                                  running, remaining)
+                            : policy->preempts(mSim, mSim->running[victim],
+                                  victimRemaining, running, remaining))
+            {
+                victim = c;
+                victimRemaining = remaining;
+            }
+        }
+
+    if(victim != -1)
+    {
+        ++mSim->preemptions;
+        if(policy->ready(mSim, stop(mSim, mEvents, victim, mTime)) != 0)
+            return 1;
+    }
+
+    return policy->ready(mSim, mP);
+}
+
+static void* simulate(void* mSim)
+{
+    Simulation* sim = (Simulation*)mSim;
+    const Trace* trace = sim->trace;
+    const Policy* policy = sim->policy;
+    double begin = now(CLOCK_THREAD_CPUTIME_ID);
+    int arrivalEvent = sim->cpus, boostEvent = sim->cpus + 1;
+    size_t next = 0, i;
+    EventQueue events;
+    int c;
+
+    sim->remaining = (int*)malloc(trace->count * sizeof(int) + 1);
+    sim->started = (unsigned char*)calloc(trace->count + 1, 1);
+    sim->level = NULL;
+    sim->used = NULL;
+    if(policy->ran != NULL)
+    {
+        sim->level = (unsigned char*)calloc(trace->count + 1, 1);
+        sim->used = (int*)calloc(trace->count + 1, sizeof(int));
+    }
+
+    vlv_initI(&sim->heap, vlalloc_system());
+    for(i = 0; i < SCHED_MLFQ_LEVELS; ++i)
+    {
+        vlv_initI(&sim->fifos[i].items, vlalloc_system());
+        sim->fifos[i].head = 0;
+    }
+
+    sim->error = sim->remaining == NULL || sim->started == NULL ||
+                 (policy->ran != NULL &&
+                     (sim->level == NULL || sim->used == NULL));
+
+    for(i = 0; i < trace->count && !sim->error; ++i)
+        sim->remaining[i] = trace->processes[i].required;
+
+    for(c = 0; c < sim->cpus; ++c) sim->running[c] = sim->lastRun[c] = -1;
+
+    eventInit(&events, sim->cpus + 2);
+    if(trace->count > 0)
+        eventSet(&events, arrivalEvent, trace->processes[0].start);
+    if(policy->boost != NULL) eventSet(&events, boostEvent, SCHED_BOOST_PERIOD);
+
+    while(events.size > 0 && !sim->error)
+    {
+        long long time = events.time[events.heap[0]];
+
+        // Completions and ends of slices, then arrivals
+        while(events.size > 0 && events.time[events.heap[0]] == time &&
+              !sim->error)
+        {
+            int id = events.heap[0];
+
+            if(id < sim->cpus)
+            {
+                int p = stop(sim, &events, id, time);
+
+                if(sim->remaining[p] == 0)
+                    complete(sim, p, time);
+                else
+                    sim->error = policy->ready(sim, p);
+            }
+            else if(id == arrivalEvent)
+            {
+                for(; next < trace->count &&
+                      trace->processes[next].start == time;
+                    ++next)
+                    if(arrive(sim, &events, (int)next, time) != 0)
+                        sim->error = 1;
+
+                if(next < trace->count)
+                    eventSet(
+                        &events, arrivalEvent, trace->processes[next].start);
+                else
+                    eventCancel(&events, arrivalEvent);
+            }
+            else
+            {
+                sim->error = policy->boost(sim, &events, time);
+
+                if(sim->completed < trace->count)
+                    eventSet(&events, boostEvent, time + SCHED_BOOST_PERIOD);
+                else
+                    eventCancel(&events, boostEvent);
+            }
+        }
+
+        // Idle CPUs take the next ready processes
+        for(c = 0; c < sim->cpus && !sim->error; ++c)
+        {
+            int p;
+
+            if(sim->running[c] != -1) continue;
+            if((p = policy->next(sim)) == -1) break;
+
+            dispatch(sim, &events, c, p, time);
+        }
+    }
+
+    sim->seconds = now(CLOCK_THREAD_CPUTIME_ID) - begin;
+
+    vlv_freeI(&sim->heap);
+    for(i = 0; i < SCHED_MLFQ_LEVELS; ++i) vlv_freeI(&sim->fifos[i].items);
+    free(sim->remaining);
+    free(sim->started);
+    free(sim->level);
+    free(sim->used);
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    Simulation sims[] = {{.name = "FCFS", .policy = &fcfs},
+        {.name = "SJF", .policy = &sjf}, {.name = "SRTF", .policy = &srtf},
+        {.name = "RR", .policy = &rr}, {.name = "MLFQ", .policy = &mlfq}};
+    pthread_t threads[VL_GET_ARRAY_SIZE(sims)];
+    bool started[VL_GET_ARRAY_SIZE(sims)];
+    int cpus = SCHED_DEFAULT_CPUS, quantumSize = SCHED_DEFAULT_QUANTUM;
+    unsigned long long required = 0;
+    size_t s;
+    double begin;
+    Trace trace;
+
+    if(argc >= 4 && strcmp(argv[1], "generate") == 0)
+    {
+        long count = atol(argv[3]);
+        unsigned long long seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+
+        if(count < 0 || generateTrace(argv[2], count, seed, SCHED_MAX_GAP) != 0)
+        {
+            fprintf(stderr, "Cannot write %s\n", argv[2]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if(argc > 3) cpus = atoi(argv[3]);
+    if(argc > 4) quantumSize = atoi(argv[4]);
+
+    if(argc < 3 || strcmp(argv[1], "run") != 0 || cpus < 1 ||
+        cpus > SCHED_MAX_CPUS || quantumSize < 1)
+    {
+        fprintf(stderr,
+            "Usage:\n\t%s generate <trace> <count> [seed]\n"
+            "\t%s run <trace> [cpus <= %d] [quantum]\n",
+            argv[0], argv[0], SCHED_MAX_CPUS);
+        return 1;
+    }
+
+    begin = now(CLOCK_MONOTONIC);
+    if(loadTrace(argv[2], &trace) != 0)
+    {
+        fprintf(stderr, "Cannot read a valid trace from %s\n", argv[2]);
+        return 1;
+    }
+
+    for(s = 0; s < trace.count; ++s) required += trace.processes[s].required;
+
+    printf("%lu processes loaded in %.2fs, %d cpus, quantum %d\n\n",
+        (unsigned long)trace.count, now(CLOCK_MONOTONIC) - begin, cpus,
+        quantumSize);
+
+    begin = now(CLOCK_MONOTONIC);
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+    {
+        sims[s].trace = &trace;
+        sims[s].cpus = cpus;
+        sims[s].quantum = quantumSize;
+        started[s] =
+            pthread_create(&threads[s], NULL, &simulate, &sims[s]) == 0;
+
+        // Run it on this thread if it cannot have its own
+        if(!started[s]) simulate(&sims[s]);
+    }
+
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+        if(started[s]) pthread_join(threads[s], NULL);
+
+    printf("%-6s %12s %12s %12s %10s %10s %12s %12s %8s %8s\n", "policy",
+        "turnaround", "waiting", "response", "max wait", "max resp",
+        "switches", "preemptions", "cpu use", "cpu s");
+
+    for(s = 0; s < VL_GET_ARRAY_SIZE(sims); ++s)
+    {
+        const Simulation* sim = &sims[s];
+        double n = trace.count > 0 ? (double)trace.count : 1.0;
+        double use = 0.0;
+
+        if(sim->error)
+        {
+            printf("%-6s out of memory\n", sim->name);
+            continue;
+        }
+
+        if(sim->endTime > 0)
+            use = 100.0 * required / ((double)sim->endTime * cpus);
+
+        printf("%-6s %12.2f %12.2f %12.2f %10lld %10lld %12llu %12llu "
+               "%7.2f%% %8.2f\n",
+            sim->name, sim->turnaround / n, sim->waiting / n,
+            sim->response / n, sim->maxWaiting, sim->maxResponse,
+            sim->contextSwitches, sim->preemptions, use, sim->seconds);
+    }
+
+    printf("\n%lld time units simulated in %.2fs\n", sims[0].endTime,
+        now(CLOCK_MONOTONIC) - begin);
+
+    free(trace.processes);
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2015 Vittorio Romeo
+// License: MIT License | http://opensource.org/licenses/MIT
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+// Process traces shared by allocatorSimulation and schedulingSimulation.
+// A trace is a text file with a line per process: start time, required
+// time and memory size. The simulators generate them with the processes
+// of second.py, each with its own gap between arrivals.
+// Needs _POSIX_C_SOURCE 200112L, for clock_gettime.
+
+#ifndef SO_TRACE
+#define SO_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <VeeLib/Global/Common.h>
+
+// Random processes of second.py
+#define TRACE_MIN_REQUIRED 4
+#define TRACE_MAX_REQUIRED 40
+#define TRACE_MIN_SIZE 10
+#define TRACE_MAX_SIZE 3500
+
+typedef struct
+{
+    int start, required, size, id;
+} Process;
+
+typedef struct
+{
+    Process* processes; // Sorted by start time
+    size_t count;
+} Trace;
+
+// Generated a random number between 'mMin' and 'mMax'
+// 'mMin' is inclusive, 'mMax' is exclusive
+static int rndI(unsigned long long* mState, int mMin, int mMax)
+{
+    // xorshift64*
+    *mState ^= *mState >> 12;
+    *mState ^= *mState << 25;
+    *mState ^= *mState >> 27;
+    return mMin +
+           (int)((*mState * 2685821657736338717ULL >> 33) % (mMax - mMin));
+}
+
+static double now(clockid_t mClock)
+{
+    struct timespec t;
+    clock_gettime(mClock, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Writes a trace of mCount random processes, arriving every mMaxGap / 2
+// time units on average. Returns 1 in case of error
+static int generateTrace(
+    const char* mPath, long mCount, unsigned long long mSeed, int mMaxGap)
+{
+    unsigned long long state = mSeed * 2 + 1;
+    FILE* file = fopen(mPath, "w");
+    long i, start = 0;
+
+    if(file == NULL) return 1;
+
+    for(i = 0; i < mCount; ++i)
+    {
+        start += rndI(&state, 0, mMaxGap);
+        fprintf(file, "%ld %d %d\n", start,
+            rndI(&state, TRACE_MIN_REQUIRED, TRACE_MAX_REQUIRED),
+            rndI(&state, TRACE_MIN_SIZE, TRACE_MAX_SIZE));
+    }
+
+    return fclose(file) != 0;
+}
+
+static int compareProcesses(const void* mA, const void* mB)
+{
+    const Process* a = (const Process*)mA;
+    const Process* b = (const Process*)mB;
+
+    if(a->start != b->start) return a->start < b->start ? -1 : 1;
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+// Reads a trace, sorting it by start time. Returns 1 in case of error
+// (including negative start times or sizes, and required times below 1)
+static int loadTrace(const char* mPath, Trace* mTrace)
+{
+    FILE* file = fopen(mPath, "rb");
+    char *buffer, *p, *end;
+    size_t capacity = 1024, length, i;
+    long fileSize;
+    bool sorted = true;
+
+    if(file == NULL) return 1;
+
+    // The whole file is parsed at once: much faster than fscanf
+    if(fseek(file, 0, SEEK_END) != 0 || (fileSize = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET) != 0 ||
+        (buffer = (char*)malloc(fileSize + 1)) == NULL)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    length = fread(buffer, 1, fileSize, file);
+    fclose(file);
+    buffer[length] = '\0';
+
+    mTrace->count = 0;
+    mTrace->processes = (Process*)malloc(capacity * sizeof(Process));
+
+    for(p = buffer; mTrace->processes != NULL; p = end)
+    {
+        Process process;
+
+        process.start = (int)strtol(p, &end, 10);
+        if(end == p) break;
+        process.required = (int)strtol(end, &end, 10);
+        process.size = (int)strtol(end, &end, 10);
+        process.id = (int)mTrace->count;
+
+        if(process.start < 0 || process.size < 0 || process.required < 1)
+        {
+            free(mTrace->processes);
+            mTrace->processes = NULL;
+            break;
+        }
+
+        if(mTrace->count == capacity)
+        {
+            Process* grown = (Process*)realloc(
+                mTrace->processes, (capacity *= 2) * sizeof(Process));
+
+            if(grown == NULL) free(mTrace->processes);
+            mTrace->processes = grown;
+            if(grown == NULL) break;
+        }
+
+        if(mTrace->count > 0 &&
+            mTrace->processes[mTrace->count - 1].start > process.start)
+            sorted = false;
+
+        mTrace->processes[mTrace->count++] = process;
+    }
+
+    free(buffer);
+    if(mTrace->processes == NULL) return 1;
+
+    // Processes are identified by their index in the sorted trace
+    if(!sorted)
+    {
+        qsort(mTrace->processes, mTrace->count, sizeof(Process),
+            &compareProcesses);
+        for(i = 0; i < mTrace->count; ++i) mTrace->processes[i].id = (int)i;
+    }
+
+    return 0;
+}
+
+#endif
@@ -2,13 +2,18 @@
 // License: Academic Free License ("AFL") v. 3.0
 // AFL License page: http://opensource.org/licenses/AFL-3.0
 
+// Defines the VeeLib operation counters when built with -DVL_COUNT_OPS,
+// and the state of the thread-caching allocator
+#define VL_COUNT_OPS_IMPL
+#define VLALLOC_IMPL
+
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
 #include <VeeLib/VeeLib.h>
+#include <VeeLib/Utils/Alloc.h>
 
 #define VL_CHOICE_COUNT 15
-#define MAX_SIZE 100
 
 void runTests();
 
@@ -198,50 +203,89 @@ bool isInArray(int* mArray, int mSize, int mNumber)
     return false;
 }
 
-void getArrayUnique(int* mArray, int mSize, int* mTarget, int* mNewSize)
+// Writes the distinct values of mArray in mTarget, in increasing order: a
+// sorted copy has its duplicates next to each other, instead of looking
+// every value up among the ones already found, in O(n^2)
+// Returns 1 in case of error (out of memory)
+int getArrayUnique(int* mArray, int mSize, VlVectorI* mTarget)
 {
-    // Possible alternative solution: sort the array first, then skip adjacent
-    // identical values.
-
-    int targetSize = 0, i;
+    size_t newSize;
 
-    for(i = 0; i < mSize; ++i)
-        if(!isInArray(mTarget, targetSize, mArray[i]))
-            mTarget[targetSize++] = mArray[i];
+    vlv_clearI(mTarget);
+    if(vlv_appendI(mTarget, mArray, mSize) != 0) return 1;
+    if(mTarget->size == 0) return 0;
 
-    *mNewSize = targetSize;
+    vla_sortShellI(mTarget->data, mTarget->size, NULL);
+    vla_uniquifyI(mTarget->data, mTarget->size, &newSize);
+    return vlv_resizeI(mTarget, newSize, 0);
 }
 
 
-void getArrayIntersection(int* mUniqueA, int mSizeA, int* mUniqueB, int mSizeB,
-    int* mTarget, int* mNewSize)
+// Writes the values of mUniqueA that are also in mUniqueB in mTarget, in
+// increasing order: sorted copies of both are walked together
+// Returns 1 in case of error (out of memory)
+int getArrayIntersection(
+    int* mUniqueA, int mSizeA, int* mUniqueB, int mSizeB, VlVectorI* mTarget)
 {
-    int targetSize = 0, i;
+    VlVectorI sortedB;
+    size_t i, j = 0, size = 0;
+
+    vlv_clearI(mTarget);
+    vlv_initI(&sortedB, vlalloc_system());
+    if(vlv_appendI(mTarget, mUniqueA, mSizeA) != 0 ||
+        vlv_appendI(&sortedB, mUniqueB, mSizeB) != 0)
+    {
+        vlv_freeI(&sortedB);
+        return 1;
+    }
 
-    for(i = 0; i < mSizeA; ++i)
-        if(isInArray(mUniqueB, mSizeB, mUniqueA[i]))
-            mTarget[targetSize++] = mUniqueA[i];
+    vla_sortShellI(mTarget->data, mTarget->size, NULL);
+    vla_sortShellI(sortedB.data, sortedB.size, NULL);
 
-    *mNewSize = targetSize;
+    for(i = 0; i < mTarget->size; ++i)
+    {
+        while(j < sortedB.size && sortedB.data[j] < mTarget->data[i]) ++j;
+        if(j < sortedB.size && sortedB.data[j] == mTarget->data[i])
+            mTarget->data[size++] = mTarget->data[i];
+    }
+
+    vlv_freeI(&sortedB);
+    return vlv_resizeI(mTarget, size, 0);
 }
 
-void getArrayUnion(int* mUniqueA, int mSizeA, int* mUniqueB, int mSizeB,
-    int* mTarget, int* mNewSize)
+// Returns 1 in case of error (out of memory)
+int getArrayUnion(
+    int* mUniqueA, int mSizeA, int* mUniqueB, int mSizeB, VlVectorI* mTarget)
 {
-    int tempArray[MAX_SIZE], tempSize = 0, i;
+    VlVectorI temp;
+    int result;
 
-    for(i = 0; i < mSizeA; ++i) tempArray[tempSize++] = mUniqueA[i];
-    for(i = 0; i < mSizeB; ++i) tempArray[tempSize++] = mUniqueB[i];
+    vlv_initI(&temp, vlalloc_system());
+    result = vlv_reserveI(&temp, mSizeA + mSizeB) != 0 ||
+             vlv_appendI(&temp, mUniqueA, mSizeA) != 0 ||
+             vlv_appendI(&temp, mUniqueB, mSizeB) != 0 ||
+             getArrayUnique(temp.data, temp.size, mTarget) != 0;
+    vlv_freeI(&temp);
 
-    getArrayUnique(tempArray, tempSize, mTarget, mNewSize);
+    return result;
 }
 
-void calcIntersection(
-    int* mA, int mSizeA, int* mB, int mSizeB, int* mTarget, int* mNewSize)
+// Returns 1 in case of error (out of memory)
+int calcIntersection(
+    int* mA, int mSizeA, int* mB, int mSizeB, VlVectorI* mTarget)
 {
-    int uniqueA[MAX_SIZE], uniqueB[MAX_SIZE], sizeUniqueA, sizeUniqueB;
-    getArrayUnique(mA, mSizeA, uniqueA, &sizeUniqueA);
-    getArrayUnique(mB, mSizeB, uniqueB, &sizeUniqueB);
+    VlVectorI uniqueA, uniqueB;
+    int result;
+
+    vlv_initI(&uniqueA, vlalloc_system());
+    vlv_initI(&uniqueB, vlalloc_system());
+    if(getArrayUnique(mA, mSizeA, &uniqueA) != 0 ||
+        getArrayUnique(mB, mSizeB, &uniqueB) != 0)
+    {
+        vlv_freeI(&uniqueA);
+        vlv_freeI(&uniqueB);
+        return 1;
+    }
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("A:\t\t\t");
@@ -260,30 +304,40 @@ void calcIntersection(
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Unique A:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
-    prettyPrintArray(uniqueA, sizeUniqueA);
+    prettyPrintArray(uniqueA.data, uniqueA.size);
     printf("\n");
     vlc_resetFmt();
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Unique B:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
-    prettyPrintArray(uniqueB, sizeUniqueB);
+    prettyPrintArray(uniqueB.data, uniqueB.size);
     printf("\n");
     vlc_resetFmt();
 
-    int sizeIntersection;
-    getArrayIntersection(
-        uniqueA, sizeUniqueA, uniqueB, sizeUniqueB, mTarget, &sizeIntersection);
+    result = getArrayIntersection(
+        uniqueA.data, uniqueA.size, uniqueB.data, uniqueB.size, mTarget);
 
-    *mNewSize = sizeIntersection;
+    vlv_freeI(&uniqueA);
+    vlv_freeI(&uniqueB);
+    return result;
 }
 
-void calcUnion(
-    int* mA, int mSizeA, int* mB, int mSizeB, int* mTarget, int* mNewSize)
+// Returns 1 in case of error (out of memory)
+int calcUnion(int* mA, int mSizeA, int* mB, int mSizeB, VlVectorI* mTarget)
 {
-    int uniqueA[MAX_SIZE], uniqueB[MAX_SIZE], sizeUniqueA, sizeUniqueB;
-    getArrayUnique(mA, mSizeA, uniqueA, &sizeUniqueA);
-    getArrayUnique(mB, mSizeB, uniqueB, &sizeUniqueB);
+    VlVectorI uniqueA, uniqueB;
+    int result;
+
+    vlv_initI(&uniqueA, vlalloc_system());
+    vlv_initI(&uniqueB, vlalloc_system());
+    if(getArrayUnique(mA, mSizeA, &uniqueA) != 0 ||
+        getArrayUnique(mB, mSizeB, &uniqueB) != 0)
+    {
+        vlv_freeI(&uniqueA);
+        vlv_freeI(&uniqueB);
+        return 1;
+    }
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("A:\t\t\t");
@@ -302,72 +356,73 @@ void calcUnion(
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Unique A:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
-    prettyPrintArray(uniqueA, sizeUniqueA);
+    prettyPrintArray(uniqueA.data, uniqueA.size);
     printf("\n");
     vlc_resetFmt();
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Unique B:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
-    prettyPrintArray(uniqueB, sizeUniqueB);
+    prettyPrintArray(uniqueB.data, uniqueB.size);
     printf("\n");
     vlc_resetFmt();
 
-    int sizeUnion;
-    getArrayUnion(
-        uniqueA, sizeUniqueA, uniqueB, sizeUniqueB, mTarget, &sizeUnion);
+    result = getArrayUnion(
+        uniqueA.data, uniqueA.size, uniqueB.data, uniqueB.size, mTarget);
 
-    *mNewSize = sizeUnion;
+    vlv_freeI(&uniqueA);
+    vlv_freeI(&uniqueB);
+    return result;
 }
 
 void choiceVExercise1()
 {
 #define SIZE_A 11
 #define SIZE_B 7
-#define SIZE_TARGET 10
 
     int a[SIZE_A] = {1, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10};
     int b[SIZE_B] = {1, 5, 2, 6, 9, 1000, 9};
-    int target[SIZE_TARGET];
 
-    int intersectionSize;
-    calcIntersection(a, SIZE_A, b, SIZE_B, target, &intersectionSize);
+    VlVectorI target;
+    vlv_initI(&target, vlalloc_system());
+    if(calcIntersection(a, SIZE_A, b, SIZE_B, &target) != 0) return;
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Intersection:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorBlue);
-    prettyPrintArray(target, intersectionSize);
+    prettyPrintArray(target.data, target.size);
     printf("\n");
     vlc_resetFmt();
 
+    vlv_freeI(&target);
+
 #undef SIZE_A
 #undef SIZE_B
-#undef SIZE_TARGET
 }
 
 void choiceVExercise2()
 {
 #define SIZE_A 11
 #define SIZE_B 7
-#define SIZE_TARGET 10
 
     int a[SIZE_A] = {1, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10};
     int b[SIZE_B] = {1, 5, 2, 6, 9, 1000, 9};
-    int target[SIZE_TARGET];
 
-    int unionSize;
-    calcUnion(a, SIZE_A, b, SIZE_B, target, &unionSize);
+    VlVectorI target;
+    vlv_initI(&target, vlalloc_system());
+    if(calcUnion(a, SIZE_A, b, SIZE_B, &target) != 0) return;
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Union:\t\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorBlue);
-    prettyPrintArray(target, unionSize);
+    prettyPrintArray(target.data, target.size);
     printf("\n");
     vlc_resetFmt();
 
+    vlv_freeI(&target);
+
 #undef SIZE_A
 #undef SIZE_B
-#undef SIZE_TARGET
 }
 
 void choiceVExercise3()
@@ -383,8 +438,9 @@ void choiceVExercise3()
 
     int a[SIZE_A] = {1, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10};
 
-    int uniqueA[MAX_SIZE], sizeUniqueA;
-    getArrayUnique(a, SIZE_A, uniqueA, &sizeUniqueA);
+    VlVectorI uniqueA;
+    vlv_initI(&uniqueA, vlalloc_system());
+    if(getArrayUnique(a, SIZE_A, &uniqueA) != 0) return;
 
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("A:\t\t\t");
@@ -396,24 +452,25 @@ void choiceVExercise3()
     vlc_setFmt(vlc_StyleBold, vlc_ColorRed);
     printf("Unique A:\t\t");
     vlc_setFmt(vlc_StyleBold, vlc_ColorYellow);
-    prettyPrintArray(uniqueA, sizeUniqueA);
+    prettyPrintArray(uniqueA.data, uniqueA.size);
     printf("\n");
     vlc_resetFmt();
 
     bool found = false;
     int iA, iB, n1, n2;
-    for(iA = 0; iA < sizeUniqueA; ++iA)
-        for(iB = 0; iB < sizeUniqueA; ++iB)
-            if(iA != iB && (uniqueA[iA] + uniqueA[iB] == desiredSum))
+    for(iA = 0; iA < (int)uniqueA.size; ++iA)
+        for(iB = 0; iB < (int)uniqueA.size; ++iB)
+            if(iA != iB && (uniqueA.data[iA] + uniqueA.data[iB] == desiredSum))
             {
-                n1 = uniqueA[iA];
-                n2 = uniqueA[iB];
+                n1 = uniqueA.data[iA];
+                n2 = uniqueA.data[iB];
                 found = true;
                 goto end;
             }
 
 end:
 
+    vlv_freeI(&uniqueA);
     printf("%s", found ? "Number found!" : "Number not found :(");
     if(found) printf(" (%d + %d)", n1, n2);
 
@@ -465,25 +522,29 @@ int eulerFunction(int* mPrimesArray, int mPrimesArraySize, int mValue)
 {
     // Returns the count of numbers coprime of mValue.
 
-    int outputArray[PRIME_COUNT];
+    VlVectorI outputArray;
+    vlv_initI(&outputArray, vlalloc_system());
+    if(vlv_resizeI(&outputArray, mPrimesArraySize, 0) != 0) return -1;
 
-    factorize(mPrimesArray, mPrimesArraySize, outputArray, mValue);
+    factorize(mPrimesArray, mPrimesArraySize, outputArray.data, mValue);
 
     printf("\nFactorized %d: ", mValue);
     int i;
-    for(i = 0; i < PRIME_COUNT; ++i)
-        if(outputArray[i] > 0)
-            printf("%d^%d, ", mPrimesArray[i], outputArray[i]);
+    for(i = 0; i < mPrimesArraySize; ++i)
+        if(outputArray.data[i] > 0)
+            printf("%d^%d, ", mPrimesArray[i], outputArray.data[i]);
 
     int result = 1;
     int idxFactor;
-    for(idxFactor = 0; idxFactor < PRIME_COUNT; ++idxFactor)
+    for(idxFactor = 0; idxFactor < mPrimesArraySize; ++idxFactor)
     {
-        if(outputArray[idxFactor] == 0) continue;
-        result *= pow(mPrimesArray[idxFactor], outputArray[idxFactor]) -
-                  pow(mPrimesArray[idxFactor], outputArray[idxFactor] - 1);
+        if(outputArray.data[idxFactor] == 0) continue;
+        result *= pow(mPrimesArray[idxFactor], outputArray.data[idxFactor]) -
+                  pow(mPrimesArray[idxFactor], outputArray.data[idxFactor] - 1);
     }
 
+    vlv_freeI(&outputArray);
+
     printf("\nRESULT: %d", result);
     printf("\n\n");
     return -1;
@@ -722,6 +783,230 @@ void runTests()
         VL_EXPECT(vla_isSortedI(array, 5) == true);
     }
 
+    {
+        VlaGapFn gapFns[] = {
+            &vla_getGapsCiura, &vla_getGapsTokuda, &vla_getGapsSedgewick};
+        size_t gaps[VLA_SHELL_MAX_GAPS];
+        int array[1000];
+        size_t f, i;
+
+        VL_EXPECT(vla_getGapsCiura(1, gaps) == 0);
+        VL_EXPECT(vla_getGapsCiura(5000, gaps) == 10);
+        VL_EXPECT(gaps[0] == 1 && gaps[8] == 1750 && gaps[9] == 3937);
+        VL_EXPECT(vla_getGapsTokuda(300, gaps) == 7);
+        VL_EXPECT(gaps[1] == 4 && gaps[3] == 20 && gaps[6] == 233);
+        VL_EXPECT(vla_getGapsSedgewick(300, gaps) == 5);
+        VL_EXPECT(gaps[1] == 8 && gaps[3] == 77 && gaps[4] == 281);
+
+        for(f = 0; f < VL_GET_ARRAY_SIZE(gapFns); ++f)
+        {
+            for(i = 0; i < 1000; ++i) array[i] = (int)((i * 7919) % 1000) % 37;
+
+            vla_sortShellI(array, 1000, gapFns[f]);
+            VL_EXPECT(vla_isSortedI(array, 1000));
+        }
+
+        vla_sortShellI(array, 1, NULL);
+        vla_sortShellI(array, 0, NULL);
+    }
+
+    {
+        static double memory[512];
+        VlArena arena;
+        size_t total;
+        char *a, *b, *c, *d, *p;
+
+        VL_EXPECT(vlarena_init(&arena, memory, 10, vlarena_FirstFit) == 1);
+        VL_EXPECT(vlarena_init(&arena, memory, sizeof(memory),
+                      vlarena_FirstFit) == 0);
+        VL_EXPECT(((size_t)arena.begin & (VLARENA_ALIGN - 1)) == 0);
+        total = vlarena_getLargestFree(&arena);
+        VL_EXPECT(vlarena_alloc(&arena, total + 1) == NULL);
+
+        a = (char*)vlarena_alloc(&arena, 400);
+        b = (char*)vlarena_alloc(&arena, 50);
+        c = (char*)vlarena_alloc(&arena, 100);
+        d = (char*)vlarena_alloc(&arena, 50);
+        VL_EXPECT(a < b && b < c && c < d);
+        VL_EXPECT(vlarena_getFragmentation(&arena) == 1);
+
+        vlarena_free(&arena, a);
+        vlarena_free(&arena, c);
+        VL_EXPECT(vlarena_getFragmentation(&arena) == 4);
+        VL_EXPECT(arena.freeBlocks == 3);
+
+        // Holes: 416 bytes at a, 128 bytes at c, the rest after d
+        p = (char*)vlarena_alloc(&arena, 100);
+        VL_EXPECT(p == a);
+        vlarena_free(&arena, p);
+
+        arena.policy = vlarena_BestFit;
+        p = (char*)vlarena_alloc(&arena, 100);
+        VL_EXPECT(p == c);
+        vlarena_free(&arena, p);
+
+        arena.policy = vlarena_WorstFit;
+        p = (char*)vlarena_alloc(&arena, 100);
+        VL_EXPECT(p > d);
+        vlarena_free(&arena, p);
+
+        arena.policy = vlarena_NextFit;
+        p = (char*)vlarena_alloc(&arena, 8);
+        VL_EXPECT(p > d);
+        VL_EXPECT((char*)vlarena_alloc(&arena, 8) > p);
+
+        vlarena_reset(&arena);
+        VL_EXPECT(vlarena_getLargestFree(&arena) == total);
+
+        a = (char*)vlarena_alloc(&arena, 100);
+        b = (char*)vlarena_alloc(&arena, 100);
+        c = (char*)vlarena_alloc(&arena, 100);
+        vlarena_free(&arena, a);
+        vlarena_free(&arena, c);
+        vlarena_free(&arena, b);
+        VL_EXPECT(arena.freeBlocks == 1 && arena.usedBlocks == 0);
+        VL_EXPECT(vlarena_getFragmentation(&arena) == 0);
+        VL_EXPECT(vlarena_getLargestFree(&arena) == total);
+
+        // A single block of 2048 bytes
+        VL_EXPECT(vlarena_init(&arena, memory, 2100, vlarena_Buddy) == 0);
+        total = vlarena_getLargestFree(&arena);
+        VL_EXPECT(total == 2048 - VLARENA_HEADER);
+        VL_EXPECT(vlarena_alloc(&arena, total + 1) == NULL);
+
+        a = (char*)vlarena_alloc(&arena, 100);
+        b = (char*)vlarena_alloc(&arena, 100);
+        c = (char*)vlarena_alloc(&arena, 200);
+        VL_EXPECT(b == a + 128 && c == a + 256);
+        VL_EXPECT(arena.usedBytes == 512);
+        VL_EXPECT(vlarena_getFragmentation(&arena) == 1);
+
+        vlarena_free(&arena, a);
+        VL_EXPECT(vlarena_getFragmentation(&arena) == 2);
+        vlarena_free(&arena, c);
+        VL_EXPECT(vlarena_alloc(&arena, 100) == a);
+        vlarena_free(&arena, a);
+        vlarena_free(&arena, b);
+        VL_EXPECT(arena.usedBlocks == 0 && arena.usedBytes == 0);
+        VL_EXPECT(vlarena_getLargestFree(&arena) == total);
+    }
+
+    {
+        static double memory[256];
+        VlArena arena;
+        VlAllocator allocators[3];
+        char *p, *q;
+        size_t i;
+
+        VL_EXPECT(vlalloc_getUsableSize(0) == 16);
+        VL_EXPECT(vlalloc_getUsableSize(1) == 16);
+        VL_EXPECT(vlalloc_getUsableSize(17) == 32);
+        VL_EXPECT(vlalloc_getUsableSize(129) == 160);
+        VL_EXPECT(vlalloc_getUsableSize(1024) == 1024);
+        VL_EXPECT(vlalloc_getUsableSize(1025) == 1025);
+
+        p = (char*)vlalloc_alloc(100);
+        q = (char*)vlalloc_alloc(100);
+        VL_EXPECT(p != NULL && q != NULL && p != q);
+        VL_EXPECT(((size_t)p & 15) == 0 && ((size_t)q & 15) == 0);
+        vlalloc_free(q, 100);
+        VL_EXPECT((char*)vlalloc_alloc(112) == q);
+        vlalloc_free(q, 112);
+        vlalloc_free(p, 100);
+        vlalloc_free(NULL, 100);
+        vlalloc_flush();
+
+        // Every allocator through the interface
+        VL_EXPECT(vlarena_init(&arena, memory, sizeof(memory),
+                      vlarena_BestFit) == 0);
+        allocators[0] = vlalloc_system();
+        allocators[1] = vlalloc_slab();
+        allocators[2] = vlalloc_arena(&arena);
+
+        for(i = 0; i < VL_GET_ARRAY_SIZE(allocators); ++i)
+        {
+            VlAllocator a = allocators[i];
+
+            p = (char*)a.alloc(a.state, 1000);
+            q = (char*)a.alloc(a.state, 10);
+            VL_EXPECT(p != NULL && q != NULL);
+            p[999] = q[9] = 1;
+            a.dealloc(a.state, p, 1000);
+            a.dealloc(a.state, q, 10);
+        }
+
+        VL_EXPECT(arena.usedBlocks == 0);
+    }
+
+    {
+        int a[] = {1, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10};
+        int b[] = {1, 5, 2, 6, 9, 1000, 9};
+        int values[100];
+        VlVectorI v;
+        int* data;
+        int i;
+
+        vlv_initI(&v, vlalloc_slab());
+        VL_EXPECT(v.size == 0 && v.capacity == 16 && v.data == v.small);
+
+        for(i = 0; i < 16; ++i) VL_EXPECT(vlv_pushI(&v, i) == 0);
+        VL_EXPECT(v.data == v.small);
+        VL_EXPECT(vlv_pushI(&v, 16) == 0);
+        VL_EXPECT(v.data != v.small && v.capacity == 32);
+        for(i = 17; i < 100; ++i) VL_EXPECT(vlv_pushI(&v, i) == 0);
+        VL_EXPECT(v.size == 100 && v.capacity == 128);
+        for(i = 0; i < 100; ++i) VL_EXPECT(v.data[i] == i);
+
+        VL_EXPECT(vlv_shrinkI(&v) == 0 && v.capacity == 100);
+        VL_EXPECT(vlv_resizeI(&v, 10, 0) == 0 && v.size == 10);
+        VL_EXPECT(vlv_shrinkI(&v) == 0 && v.data == v.small);
+        VL_EXPECT(v.capacity == 16);
+        VL_EXPECT(v.data[9] == 9);
+
+        data = v.data;
+        VL_EXPECT(vlv_reserveI(&v, 16) == 0 && v.data == data);
+        vlv_pushUncheckedI(&v, 10);
+        VL_EXPECT(vlv_resizeI(&v, 20, -1) == 0 && v.data[10] == 10);
+        VL_EXPECT(v.data[19] == -1);
+
+        for(i = 0; i < 100; ++i) values[i] = i * 2;
+        vlv_clearI(&v);
+        VL_EXPECT(vlv_appendI(&v, values, 100) == 0 && v.size == 100);
+        VL_EXPECT(vlv_appendI(&v, values, 0) == 0 && v.data[99] == 198);
+        vlv_freeI(&v);
+        VL_EXPECT(v.size == 0 && v.data == v.small);
+
+        // The union has more elements than the old fixed target buffer
+        vlv_initI(&v, vlalloc_system());
+        VL_EXPECT(getArrayUnion(a, 11, b, 7, &v) == 0 && v.size == 11);
+        VL_EXPECT(v.data[10] == 1000);
+        VL_EXPECT(getArrayIntersection(a, 11, b, 7, &v) == 0 && v.size == 6);
+        VL_EXPECT(v.data[0] == 1 && v.data[1] == 1 && v.data[5] == 9);
+        VL_EXPECT(getArrayUnique(values, 100, &v) == 0 && v.size == 100);
+        VL_EXPECT(getArrayUnique(a, 11, &v) == 0 && v.size == 10);
+        VL_EXPECT(v.data[0] == 1 && v.data[9] == 10);
+        VL_EXPECT(getArrayUnique(a, 0, &v) == 0 && v.size == 0);
+        vlv_freeI(&v);
+    }
+
+#ifdef VL_COUNT_OPS
+    {
+        int array[] = {2, 5, 1, 4, 7, 1};
+        VlOps ops;
+
+        vlops_reset();
+        vla_sortSelectionI(array, 6);
+        ops = vlops_get();
+        VL_EXPECT(ops.comparisons == 20);
+        VL_EXPECT(ops.swaps == 5);
+        VL_EXPECT(ops.probes == 0);
+
+        vlops_reset();
+        VL_EXPECT(vla_linearSearchI(array, 6, 4) == 3);
+        VL_EXPECT(vlops_get().probes == 4);
+    }
+#endif
+
     {
         VL_EXPECT(vlm_getFibonacciI(1) == 1);
         VL_EXPECT(vlm_getFibonacciI(2) == 1);
@@ -730,4 +1015,62 @@ void runTests()
         VL_EXPECT(vlm_getFibonacciI(5) == 5);
         VL_EXPECT(vlm_getFibonacciI(6) == 8);
     }
+
+    {
+        VL_EXPECT(vlm_isqrtUL(0) == 0);
+        VL_EXPECT(vlm_isqrtUL(15) == 3);
+        VL_EXPECT(vlm_isqrtUL(16) == 4);
+        VL_EXPECT(vlm_isqrtUL(ULONG_MAX) == VLM_ISQRT_MAX_UL);
+
+        VL_EXPECT(vlm_icbrtUL(0) == 0);
+        VL_EXPECT(vlm_icbrtUL(26) == 2);
+        VL_EXPECT(vlm_icbrtUL(27) == 3);
+        VL_EXPECT(vlm_icbrtUL(ULONG_MAX) == VLM_ICBRT_MAX_UL);
+
+        VL_EXPECT(vlm_isPerfectSquareUL(144) == true);
+        VL_EXPECT(vlm_isPerfectSquareUL(145) == false);
+        VL_EXPECT(vlm_isPerfectCubeUL(125) == true);
+        VL_EXPECT(vlm_isPerfectCubeUL(126) == false);
+
+        unsigned long src[] = {1, 8, 9, 63, 64, 1000};
+        unsigned long dst[6];
+
+        vlm_isqrtBatchUL(src, dst, 6);
+        VL_EXPECT(dst[2] == 3);
+        VL_EXPECT(dst[3] == 7);
+        VL_EXPECT(dst[5] == 31);
+
+        vlm_icbrtBatchUL(src, dst, 6);
+        VL_EXPECT(dst[1] == 2);
+        VL_EXPECT(dst[3] == 3);
+        VL_EXPECT(dst[5] == 10);
+    }
+
+    {
+        float coeffs[] = {1.f, -2.f, 3.f}; // 1 - 2x + 3x^2
+        float xs[] = {0.f, 1.f, 2.f}, ys[3];
+
+        VL_EXPECT(vlpoly_hornerF(coeffs, 3, 2.f) == 9.f);
+        VL_EXPECT(vlpoly_estrinF(coeffs, 3, 2.f) == 9.f);
+
+        vlpoly_hornerArrayF(coeffs, 3, xs, ys, 3);
+        VL_EXPECT(ys[0] == 1.f);
+        VL_EXPECT(ys[1] == 2.f);
+        VL_EXPECT(ys[2] == 9.f);
+
+        VL_EXPECT(fabs(vlpoly_sinF(1.f) - sin(1.0)) < 1e-7);
+        VL_EXPECT(fabs(vlpoly_cosF(100.f) - cos(100.0)) < 1e-7);
+        VL_EXPECT(vlpoly_sinF(1e20f) == sinf(1e20f));
+        VL_EXPECT(vlpoly_cosF(-1e20f) == cosf(-1e20f));
+        {
+            float big[2] = {1e20f, 1.f}, out[2];
+
+            vlpoly_sinArrayF(big, out, 2);
+            VL_EXPECT(out[0] == sinf(1e20f) && out[1] == vlpoly_sinF(1.f));
+        }
+        VL_EXPECT(fabs(vlpoly_expF(2.f) - exp(2.0)) < 1e-6);
+        VL_EXPECT(fabs(vlpoly_logF(10.f) - log(10.0)) < 1e-6);
+        VL_EXPECT(vlpoly_logF(1.f) == 0.f);
+        VL_EXPECT(vlpoly_expF(0.f) == 1.f);
+    }
 }
@@ -0,0 +1,253 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// Allocator contention benchmark.
+// Every thread keeps ALLOC_BENCH_LIVE blocks of random sizes (up to
+// VLALLOC_MAX_SIZE bytes) alive, repeatedly freeing the oldest one and
+// allocating a new one; every few operations the freed block is one
+// allocated by the next thread, so memory also moves between threads. Each
+// allocator is run with 1, 2, 4, ... threads, up to the given count, all
+// started together, and the total throughput is reported, both as a table
+// and as a JSON file.
+//
+// Usage: veelib_alloc_bench [output.json] [operations per thread] [threads]
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <VeeLib/VeeLib.h>
+
+#define VLALLOC_IMPL
+#include <VeeLib/Utils/Alloc.h>
+
+#define ALLOC_BENCH_DEFAULT_OPERATIONS 1000000
+#define ALLOC_BENCH_DEFAULT_THREADS 64
+#define ALLOC_BENCH_MAX_THREADS 256
+
+// Blocks alive in every thread
+#define ALLOC_BENCH_LIVE 256
+
+// One operation every ALLOC_BENCH_REMOTE frees a block of another thread
+#define ALLOC_BENCH_REMOTE 16
+
+typedef struct
+{
+    const char* name;
+    VlAllocator (*get)();
+} AllocBenchAllocator;
+
+static const AllocBenchAllocator allocBenchAllocators[] = {
+    {"malloc", vlalloc_system}, {"vlalloc", vlalloc_slab}};
+
+typedef struct
+{
+    VlAllocator allocator;
+    size_t operations;
+    unsigned int seed;
+    pthread_barrier_t* barrier;
+    int failed; // An allocation returned NULL
+
+    // Handed to the next thread, which frees it
+    pthread_mutex_t mutex;
+    void* mailbox;
+    size_t mailboxSize;
+} AllocBenchThread;
+
+static AllocBenchThread allocBenchThreads[ALLOC_BENCH_MAX_THREADS];
+static int allocBenchThreadCount;
+
+static double allocBenchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static unsigned int allocBenchRandom(unsigned int* mState)
+{
+    *mState ^= *mState << 13;
+    *mState ^= *mState >> 17;
+    *mState ^= *mState << 5;
+    return *mState;
+}
+
+static void* allocBenchWorker(void* mData)
+{
+    AllocBenchThread* self = (AllocBenchThread*)mData;
+    AllocBenchThread* next = &allocBenchThreads[
+        (self - allocBenchThreads + 1) % allocBenchThreadCount];
+    VlAllocator a = self->allocator;
+    void* live[ALLOC_BENCH_LIVE] = {NULL};
+    size_t sizes[ALLOC_BENCH_LIVE] = {0};
+    size_t i, slot;
+
+    // A failed thread still waits at both barriers, or the others (and
+    // allocBenchRun) would wait for it forever
+    for(i = 0; i < ALLOC_BENCH_LIVE && !self->failed; ++i)
+    {
+        sizes[i] = 1 + allocBenchRandom(&self->seed) % VLALLOC_MAX_SIZE;
+        live[i] = a.alloc(a.state, sizes[i]);
+        if(live[i] == NULL)
+            self->failed = 1;
+        else
+            *(char*)live[i] = 0;
+    }
+
+    pthread_barrier_wait(self->barrier);
+
+    for(i = 0, slot = 0; i < self->operations && !self->failed; ++i)
+    {
+        if(i % ALLOC_BENCH_REMOTE == 0)
+        {
+            // Swap the oldest block with the one in the mailbox of the next
+            // thread, which will free it
+            void* ptr = live[slot];
+            size_t size = sizes[slot];
+
+            pthread_mutex_lock(&next->mutex);
+            live[slot] = next->mailbox;
+            sizes[slot] = next->mailboxSize;
+            next->mailbox = ptr;
+            next->mailboxSize = size;
+            pthread_mutex_unlock(&next->mutex);
+
+            a.dealloc(a.state, live[slot], sizes[slot]);
+        }
+        else
+            a.dealloc(a.state, live[slot], sizes[slot]);
+
+        sizes[slot] = 1 + allocBenchRandom(&self->seed) % VLALLOC_MAX_SIZE;
+        live[slot] = a.alloc(a.state, sizes[slot]);
+        if(live[slot] == NULL)
+        {
+            self->failed = 1;
+            break;
+        }
+        *(char*)live[slot] = 0;
+
+        if(++slot == ALLOC_BENCH_LIVE) slot = 0;
+    }
+
+    pthread_barrier_wait(self->barrier);
+
+    // Freeing NULL does nothing
+    for(i = 0; i < ALLOC_BENCH_LIVE; ++i)
+        a.dealloc(a.state, live[i], sizes[i]);
+    vlalloc_flush();
+
+    return NULL;
+}
+
+// Runs mThreads threads with mAllocator and returns the wall time of the
+// operations, or a negative number in case of error
+static double allocBenchRun(
+    VlAllocator mAllocator, int mThreads, size_t mOperations)
+{
+    pthread_t threads[ALLOC_BENCH_MAX_THREADS];
+    pthread_barrier_t barrier;
+    double begin, end;
+    int t, failed = 0;
+
+    if(pthread_barrier_init(&barrier, NULL, (unsigned int)mThreads + 1) != 0)
+        return -1;
+
+    allocBenchThreadCount = mThreads;
+    for(t = 0; t < mThreads; ++t)
+    {
+        AllocBenchThread* thread = &allocBenchThreads[t];
+
+        thread->allocator = mAllocator;
+        thread->operations = mOperations;
+        thread->seed = 2463534242u + 7919u * (unsigned int)t;
+        thread->barrier = &barrier;
+        thread->failed = 0;
+        pthread_mutex_init(&thread->mutex, NULL);
+        thread->mailbox = NULL;
+        thread->mailboxSize = 0;
+    }
+
+    for(t = 0; t < mThreads; ++t)
+        if(pthread_create(&threads[t], NULL, allocBenchWorker,
+               &allocBenchThreads[t]) != 0)
+            return -1;
+
+    pthread_barrier_wait(&barrier);
+    begin = allocBenchNow();
+    pthread_barrier_wait(&barrier);
+    end = allocBenchNow();
+
+    for(t = 0; t < mThreads; ++t)
+    {
+        pthread_join(threads[t], NULL);
+        failed |= allocBenchThreads[t].failed;
+
+        mAllocator.dealloc(mAllocator.state, allocBenchThreads[t].mailbox,
+            allocBenchThreads[t].mailboxSize);
+        pthread_mutex_destroy(&allocBenchThreads[t].mutex);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    return failed ? -1 : end - begin;
+}
+
+int main(int argc, char** argv)
+{
+    const char* outputPath = argc > 1 ? argv[1] : "veelib_alloc_bench.json";
+    size_t operations =
+        argc > 2 ? (size_t)atol(argv[2]) : ALLOC_BENCH_DEFAULT_OPERATIONS;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : ALLOC_BENCH_DEFAULT_THREADS;
+    FILE* output;
+    size_t k;
+    int threads, first = 1;
+
+    if(operations == 0 || maxThreads < 1 ||
+        maxThreads > ALLOC_BENCH_MAX_THREADS)
+    {
+        fprintf(stderr,
+            "Usage: %s [output.json] [operations per thread] [threads <= %d]\n",
+            argv[0], ALLOC_BENCH_MAX_THREADS);
+        return 1;
+    }
+
+    output = fopen(outputPath, "w");
+    if(output == NULL) return 1;
+
+    fprintf(output, "{\n  \"operations_per_thread\": %lu,\n"
+                    "  \"live_per_thread\": %d,\n  \"max_size\": %d,\n"
+                    "  \"results\": [",
+        (unsigned long)operations, ALLOC_BENCH_LIVE, VLALLOC_MAX_SIZE);
+
+    printf("%-10s %8s %12s %14s %16s\n", "allocator", "threads", "seconds",
+        "ns per op", "ops per second");
+
+    for(threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        for(k = 0; k < VL_GET_ARRAY_SIZE(allocBenchAllocators); ++k)
+        {
+            const AllocBenchAllocator* allocator = &allocBenchAllocators[k];
+            double seconds =
+                allocBenchRun(allocator->get(), threads, operations);
+            double total = (double)operations * threads;
+
+            if(seconds < 0) return 1;
+
+            printf("%-10s %8d %12.3f %14.3f %16.0f\n", allocator->name, threads,
+                seconds, seconds * 1e9 / total, total / seconds);
+
+            fprintf(output,
+                "%s\n    {\"allocator\": \"%s\", \"threads\": %d, "
+                "\"seconds\": %.6f, \"ns_per_operation\": %.4f, "
+                "\"per_second\": %.0f}",
+                first ? "" : ",", allocator->name, threads, seconds,
+                seconds * 1e9 / total, total / seconds);
+            first = 0;
+        }
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+    fclose(output);
+    return 0;
+}
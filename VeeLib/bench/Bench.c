@@ -0,0 +1,745 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+// VeeLib benchmark suite.
+// Every kernel is timed over every input distribution: after a few warm-up
+// runs, each repetition is timed on its own and the median and the 95th
+// percentile of the time per element are reported, both as a table and as
+// a JSON file that can be diffed across commits.
+//
+// Usage: veelib_bench [output.json] [size] [repetitions]
+//
+// When built with VL_PERF, every kernel is also run once under the
+// hardware performance counters (see Global/Perf.h), printed after each
+// distribution.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <string.h>
+#include <time.h>
+#include <VeeLib/VeeLib.h>
+
+#define BENCH_DEFAULT_SIZE 100000
+#define BENCH_DEFAULT_REPETITIONS 15
+#define BENCH_WARMUP 2
+#define BENCH_MAX_REPETITIONS 1000
+
+// Distinct values of the few-unique and Zipf distributions
+#define BENCH_FEW_UNIQUE 16
+#define BENCH_ZIPF_VALUES 4096
+
+// Queries timed by the linear search kernel (each scans the whole array)
+#define BENCH_LINEAR_QUERIES 64
+
+// Quadratic kernels are run on at most this many elements
+#define BENCH_QUADRATIC_MAX 4096
+
+// Arena kernels keep this many blocks alive, each of at most
+// BENCH_ARENA_MAX_REQUEST bytes, in an arena large enough for all of them
+#define BENCH_ARENA_LIVE 1024
+#define BENCH_ARENA_MAX_REQUEST 1024
+#define BENCH_ARENA_SIZE \
+    (2 * BENCH_ARENA_LIVE * (BENCH_ARENA_MAX_REQUEST + VLARENA_MIN_BLOCK))
+
+typedef enum
+{
+    BenchRandom,
+    BenchSorted,
+    BenchReversed,
+    BenchOrganPipe,
+    BenchFewUnique,
+    BenchZipf,
+    BenchDistributionCount
+} BenchDistribution;
+
+static const char* benchDistributionNames[BenchDistributionCount] = {
+    "random", "sorted", "reversed", "organ_pipe", "few_unique", "zipf"};
+
+/// @brief Input and work buffers shared by the kernels.
+/// @details `prepare` functions rebuild the work buffers from `input` before
+/// every timed run, so in-place kernels always see the same data.
+typedef struct
+{
+    const int* input;
+    size_t size;
+    int* work;
+    int* sorted; // `input`, sorted
+    unsigned long* ulongs;
+    float* floats;
+    float* results;
+    VlArena arena;
+    void** live; // BENCH_ARENA_LIVE blocks allocated from `arena`
+} BenchData;
+
+/// @brief A benchmarked kernel.
+/// @details `run` is the only timed part: it returns the number of units
+/// (elements or queries, see `unit`) the time is divided by.
+typedef struct
+{
+    const char* name;
+    const char* category;
+    const char* unit;
+    size_t maxSize; // 0 if unlimited
+    void (*prepare)(BenchData*);
+    size_t (*run)(BenchData*);
+} BenchKernel;
+
+/// @brief Results of the kernels are accumulated here, so that the compiler
+/// cannot optimize them away.
+static volatile unsigned long benchSink;
+
+/// @brief SplitMix64 step.
+static unsigned long long benchRandom(unsigned long long* mState)
+{
+    unsigned long long z = (*mState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// @brief Fills mArray with mSize values of distribution mDistribution.
+/// @details Zipf values follow P(k) ~ 1 / k over BENCH_ZIPF_VALUES ranks,
+/// sampled by binary search in the cumulative distribution; ranks are
+/// scrambled so that frequent values are not also the smallest ones.
+/// @return Returns 1 in case of error.
+static int benchFill(int* mArray, size_t mSize, BenchDistribution mDistribution)
+{
+    unsigned long long state = 12345;
+    double* cumulative;
+    size_t i;
+
+    switch(mDistribution)
+    {
+        case BenchRandom:
+            for(i = 0; i < mSize; ++i)
+                mArray[i] = (int)(benchRandom(&state) >> 33);
+            return 0;
+
+        case BenchSorted:
+            for(i = 0; i < mSize; ++i) mArray[i] = (int)i;
+            return 0;
+
+        case BenchReversed:
+            for(i = 0; i < mSize; ++i) mArray[i] = (int)(mSize - i);
+            return 0;
+
+        case BenchOrganPipe:
+            for(i = 0; i < mSize; ++i)
+                mArray[i] = (int)(i < mSize / 2 ? i : mSize - i);
+            return 0;
+
+        case BenchFewUnique:
+            for(i = 0; i < mSize; ++i)
+                mArray[i] = (int)(benchRandom(&state) % BENCH_FEW_UNIQUE);
+            return 0;
+
+        default: break;
+    }
+
+    cumulative = (double*)malloc(BENCH_ZIPF_VALUES * sizeof(double));
+    if(cumulative == NULL) return 1;
+
+    for(i = 0; i < BENCH_ZIPF_VALUES; ++i)
+        cumulative[i] = (i > 0 ? cumulative[i - 1] : 0.0) + 1.0 / (i + 1);
+
+    for(i = 0; i < mSize; ++i)
+    {
+        double u = (benchRandom(&state) >> 11) * (1.0 / 9007199254740992.0) *
+                   cumulative[BENCH_ZIPF_VALUES - 1];
+        size_t lb = 0, ub = BENCH_ZIPF_VALUES - 1;
+
+        while(lb < ub)
+        {
+            size_t mid = (lb + ub) / 2;
+            if(cumulative[mid] < u)
+                lb = mid + 1;
+            else
+                ub = mid;
+        }
+
+        mArray[i] = (int)((lb * 2654435761UL) % 1000003);
+    }
+
+    free(cumulative);
+    return 0;
+}
+
+// Prepare functions
+
+static void benchCopyInput(BenchData* mD)
+{
+    memcpy(mD->work, mD->input, mD->size * sizeof(int));
+}
+
+static void benchCopySorted(BenchData* mD)
+{
+    memcpy(mD->work, mD->sorted, mD->size * sizeof(int));
+}
+
+static void benchToULongs(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i)
+        mD->ulongs[i] = (unsigned long)mD->input[i] * 2654435761UL;
+}
+
+// Angles and exponents in [-10, 10)
+static void benchToFloats(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i)
+        mD->floats[i] = (mD->input[i] % 2000) / 100.f - 10.f;
+}
+
+// Positive values for log
+static void benchToPositiveFloats(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i)
+        mD->floats[i] = (mD->input[i] % 100000) * 0.01f + 0.001f;
+}
+
+// Arguments whose result fits in an int: 1 to 12 for the factorial, 1 to
+// 46 for the Fibonacci numbers
+static void benchToFactorialArgs(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->work[i] = mD->input[i] % 12 + 1;
+}
+
+static void benchToFibonacciArgs(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->work[i] = mD->input[i] % 46 + 1;
+}
+
+// At most 9 digits, so that the reversed value fits in an int
+static void benchToReversibleInts(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->work[i] = mD->input[i] % 1000000000;
+}
+
+// A valid digit position of every input value
+static void benchToDigitPositions(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i)
+        mD->work[i] = (int)(i % vlm_getNumberOfDigitsI(mD->input[i]));
+}
+
+static void benchNothing(BenchData* mD) { (void)mD; }
+
+static void benchArenaPrepare(BenchData* mD, VlArenaPolicy mPolicy)
+{
+    mD->arena.policy = mPolicy;
+    vlarena_reset(&mD->arena);
+    memset(mD->live, 0, BENCH_ARENA_LIVE * sizeof(void*));
+}
+
+static void benchArenaFirstFit(BenchData* mD)
+{
+    benchArenaPrepare(mD, vlarena_FirstFit);
+}
+
+static void benchArenaNextFit(BenchData* mD)
+{
+    benchArenaPrepare(mD, vlarena_NextFit);
+}
+
+static void benchArenaBestFit(BenchData* mD)
+{
+    benchArenaPrepare(mD, vlarena_BestFit);
+}
+
+static void benchArenaWorstFit(BenchData* mD)
+{
+    benchArenaPrepare(mD, vlarena_WorstFit);
+}
+
+static void benchArenaBuddy(BenchData* mD)
+{
+    benchArenaPrepare(mD, vlarena_Buddy);
+}
+
+// Kernels
+
+static size_t benchSortSelection(BenchData* mD)
+{
+    vla_sortSelectionI(mD->work, mD->size);
+    benchSink += mD->work[0];
+    return mD->size;
+}
+
+static size_t benchSortShellCiura(BenchData* mD)
+{
+    vla_sortShellI(mD->work, mD->size, &vla_getGapsCiura);
+    benchSink += mD->work[0];
+    return mD->size;
+}
+
+static size_t benchSortShellTokuda(BenchData* mD)
+{
+    vla_sortShellI(mD->work, mD->size, &vla_getGapsTokuda);
+    benchSink += mD->work[0];
+    return mD->size;
+}
+
+static size_t benchSortShellSedgewick(BenchData* mD)
+{
+    vla_sortShellI(mD->work, mD->size, &vla_getGapsSedgewick);
+    benchSink += mD->work[0];
+    return mD->size;
+}
+
+// Moves the first element to the end, shifting all the others
+static size_t benchShiftToEnd(BenchData* mD)
+{
+    vla_shiftToEndI(mD->work, mD->size, 0);
+    benchSink += mD->work[0];
+    return mD->size;
+}
+
+// Queries are values taken from the input, so they are always found
+static size_t benchBinarySearch(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i)
+        benchSink += vla_binarySearchI(mD->sorted, mD->size, mD->input[i]);
+    return mD->size;
+}
+
+static size_t benchLinearSearch(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < BENCH_LINEAR_QUERIES; ++i)
+        benchSink += vla_linearSearchI((int*)mD->input, mD->size,
+            mD->sorted[(i * 7919) % mD->size]);
+    return BENCH_LINEAR_QUERIES;
+}
+
+static size_t benchUniquify(BenchData* mD)
+{
+    size_t newSize;
+    vla_uniquifyI(mD->work, mD->size, &newSize);
+    benchSink += newSize;
+    return mD->size;
+}
+
+static size_t benchMinValueIdx(BenchData* mD)
+{
+    benchSink += vla_getMinValueIdxI((int*)mD->input, 0, mD->size);
+    return mD->size;
+}
+
+static size_t benchIsSorted(BenchData* mD)
+{
+    benchSink += vla_isSortedI(mD->sorted, mD->size);
+    return mD->size;
+}
+
+static size_t benchNumberOfDigits(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_getNumberOfDigitsI(mD->input[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchReversed(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_getReversedI(mD->work[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchDigitFromRightAt(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i)
+        sum += vlm_getDigitFromRightAtI(mD->input[i], mD->work[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchFactorial(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_getFactorialI(mD->work[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchFibonacci(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_getFibonacciI(mD->work[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchIsqrt(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_isqrtUL(mD->ulongs[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchIcbrt(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_icbrtUL(mD->ulongs[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchIsPerfectSquare(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_isPerfectSquareUL(mD->ulongs[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchIsPerfectCube(BenchData* mD)
+{
+    size_t i;
+    unsigned long sum = 0;
+    for(i = 0; i < mD->size; ++i) sum += vlm_isPerfectCubeUL(mD->ulongs[i]);
+    benchSink += sum;
+    return mD->size;
+}
+
+static size_t benchIsqrtBatch(BenchData* mD)
+{
+    vlm_isqrtBatchUL(mD->ulongs, mD->ulongs, mD->size);
+    benchSink += mD->ulongs[0];
+    return mD->size;
+}
+
+static size_t benchIcbrtBatch(BenchData* mD)
+{
+    vlm_icbrtBatchUL(mD->ulongs, mD->ulongs, mD->size);
+    benchSink += mD->ulongs[0];
+    return mD->size;
+}
+
+static size_t benchHornerArray(BenchData* mD)
+{
+    static const float coeffs[] = {1.f, -0.5f, 0.25f, -0.125f, 0.0625f,
+        -0.03125f, 0.015625f, -0.0078125f};
+
+    vlpoly_hornerArrayF(coeffs, VL_GET_ARRAY_SIZE(coeffs), mD->floats,
+        mD->results, mD->size);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchSin(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->results[i] = vlpoly_sinF(mD->floats[i]);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchCos(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->results[i] = vlpoly_cosF(mD->floats[i]);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchExp(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->results[i] = vlpoly_expF(mD->floats[i]);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchLog(BenchData* mD)
+{
+    size_t i;
+    for(i = 0; i < mD->size; ++i) mD->results[i] = vlpoly_logF(mD->floats[i]);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchSinArray(BenchData* mD)
+{
+    vlpoly_sinArrayF(mD->floats, mD->results, mD->size);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchCosArray(BenchData* mD)
+{
+    vlpoly_cosArrayF(mD->floats, mD->results, mD->size);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchExpArray(BenchData* mD)
+{
+    vlpoly_expArrayF(mD->floats, mD->results, mD->size);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+static size_t benchLogArray(BenchData* mD)
+{
+    vlpoly_logArrayF(mD->floats, mD->results, mD->size);
+    benchSink += (unsigned long)mD->results[0];
+    return mD->size;
+}
+
+// One operation frees the oldest live block and allocates a new one, its
+// size taken from the input
+static size_t benchArena(BenchData* mD)
+{
+    size_t i;
+
+    for(i = 0; i < mD->size; ++i)
+    {
+        void** slot = &mD->live[i % BENCH_ARENA_LIVE];
+
+        vlarena_free(&mD->arena, *slot);
+        *slot = vlarena_alloc(&mD->arena,
+            (unsigned int)mD->input[i] % BENCH_ARENA_MAX_REQUEST);
+    }
+
+    benchSink += vlarena_getFragmentation(&mD->arena);
+    return mD->size;
+}
+
+static const BenchKernel benchKernels[] = {
+    {"vla_sortSelectionI", "sort", "element", BENCH_QUADRATIC_MAX,
+        &benchCopyInput, &benchSortSelection},
+    {"vla_sortShellI/ciura", "sort", "element", 0, &benchCopyInput,
+        &benchSortShellCiura},
+    {"vla_sortShellI/tokuda", "sort", "element", 0, &benchCopyInput,
+        &benchSortShellTokuda},
+    {"vla_sortShellI/sedgewick", "sort", "element", 0, &benchCopyInput,
+        &benchSortShellSedgewick},
+    {"vla_shiftToEndI", "move", "element", 0, &benchCopyInput,
+        &benchShiftToEnd},
+    {"vla_binarySearchI", "search", "query", 0, &benchNothing,
+        &benchBinarySearch},
+    {"vla_linearSearchI", "search", "query", 0, &benchNothing,
+        &benchLinearSearch},
+    {"vla_uniquifyI", "set", "element", 0, &benchCopySorted, &benchUniquify},
+    {"vla_getMinValueIdxI", "reduction", "element", 0, &benchNothing,
+        &benchMinValueIdx},
+    {"vla_isSortedI", "reduction", "element", 0, &benchNothing,
+        &benchIsSorted},
+    {"vlm_getNumberOfDigitsI", "math", "element", 0, &benchNothing,
+        &benchNumberOfDigits},
+    {"vlm_getReversedI", "math", "element", 0, &benchToReversibleInts,
+        &benchReversed},
+    {"vlm_getDigitFromRightAtI", "math", "element", 0,
+        &benchToDigitPositions, &benchDigitFromRightAt},
+    {"vlm_getFactorialI", "math", "element", 0, &benchToFactorialArgs,
+        &benchFactorial},
+    {"vlm_getFibonacciI", "math", "element", 0, &benchToFibonacciArgs,
+        &benchFibonacci},
+    {"vlm_isqrtUL", "math", "element", 0, &benchToULongs, &benchIsqrt},
+    {"vlm_icbrtUL", "math", "element", 0, &benchToULongs, &benchIcbrt},
+    {"vlm_isPerfectSquareUL", "math", "element", 0, &benchToULongs,
+        &benchIsPerfectSquare},
+    {"vlm_isPerfectCubeUL", "math", "element", 0, &benchToULongs,
+        &benchIsPerfectCube},
+    {"vlm_isqrtBatchUL", "math", "element", 0, &benchToULongs,
+        &benchIsqrtBatch},
+    {"vlm_icbrtBatchUL", "math", "element", 0, &benchToULongs,
+        &benchIcbrtBatch},
+    {"vlpoly_hornerArrayF", "math", "element", 0, &benchToFloats,
+        &benchHornerArray},
+    {"vlpoly_sinF", "math", "element", 0, &benchToFloats, &benchSin},
+    {"vlpoly_cosF", "math", "element", 0, &benchToFloats, &benchCos},
+    {"vlpoly_expF", "math", "element", 0, &benchToFloats, &benchExp},
+    {"vlpoly_logF", "math", "element", 0, &benchToPositiveFloats, &benchLog},
+    {"vlpoly_sinArrayF", "math", "element", 0, &benchToFloats,
+        &benchSinArray},
+    {"vlpoly_cosArrayF", "math", "element", 0, &benchToFloats,
+        &benchCosArray},
+    {"vlpoly_expArrayF", "math", "element", 0, &benchToFloats,
+        &benchExpArray},
+    {"vlpoly_logArrayF", "math", "element", 0, &benchToPositiveFloats,
+        &benchLogArray},
+    {"vlarena/first_fit", "alloc", "operation", 0, &benchArenaFirstFit,
+        &benchArena},
+    {"vlarena/next_fit", "alloc", "operation", 0, &benchArenaNextFit,
+        &benchArena},
+    {"vlarena/best_fit", "alloc", "operation", 0, &benchArenaBestFit,
+        &benchArena},
+    {"vlarena/worst_fit", "alloc", "operation", 0, &benchArenaWorstFit,
+        &benchArena},
+    {"vlarena/buddy", "alloc", "operation", 0, &benchArenaBuddy, &benchArena}};
+
+static double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static int benchCompareDoubles(const void* mA, const void* mB)
+{
+    double a = *(const double*)mA, b = *(const double*)mB;
+    return (a > b) - (a < b);
+}
+
+static int benchCompareInts(const void* mA, const void* mB)
+{
+    int a = *(const int*)mA, b = *(const int*)mB;
+    return (a > b) - (a < b);
+}
+
+/// @brief Times mKernel over mD and writes the median and the 95th
+/// percentile of the nanoseconds per unit.
+static void benchRun(const BenchKernel* mKernel, BenchData* mD,
+    int mRepetitions, double* mSamples, double* mMedian, double* mP95)
+{
+    int r;
+
+    for(r = 0; r < BENCH_WARMUP; ++r)
+    {
+        (*mKernel->prepare)(mD);
+        (*mKernel->run)(mD);
+    }
+
+    for(r = 0; r < mRepetitions; ++r)
+    {
+        double begin;
+        size_t units;
+
+        (*mKernel->prepare)(mD);
+        begin = benchNow();
+        units = (*mKernel->run)(mD);
+        mSamples[r] = (benchNow() - begin) / units;
+    }
+
+#ifdef VL_PERF
+    {
+        // One more run, measured by the hardware counters
+        VlPerfSample sample;
+        int id = -1;
+
+        (*mKernel->prepare)(mD);
+        vlperf_begin(&id, mKernel->name, &sample);
+        (*mKernel->run)(mD);
+        vlperf_end(id, &sample);
+    }
+#endif
+
+    qsort(mSamples, mRepetitions, sizeof(double), &benchCompareDoubles);
+    *mMedian = mSamples[mRepetitions / 2];
+    *mP95 = mSamples[(int)ceil(0.95 * mRepetitions) - 1];
+}
+
+int main(int argc, char** argv)
+{
+    const char* outputPath = argc > 1 ? argv[1] : "veelib_bench.json";
+    size_t size = argc > 2 ? (size_t)atol(argv[2]) : BENCH_DEFAULT_SIZE;
+    int repetitions = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_REPETITIONS;
+    double samples[BENCH_MAX_REPETITIONS];
+    int* input = (int*)malloc(size * sizeof(int));
+    BenchData data;
+    void* arenaMemory;
+    FILE* output;
+    size_t k;
+    int d, first = 1;
+
+    if(size == 0 || repetitions < 1 || repetitions > BENCH_MAX_REPETITIONS)
+    {
+        fprintf(stderr, "Usage: %s [output.json] [size] [repetitions <= %d]\n",
+            argv[0], BENCH_MAX_REPETITIONS);
+        return 1;
+    }
+
+    data.input = input;
+    data.work = (int*)malloc(size * sizeof(int));
+    data.sorted = (int*)malloc(size * sizeof(int));
+    data.ulongs = (unsigned long*)malloc(size * sizeof(unsigned long));
+    data.floats = (float*)malloc(size * sizeof(float));
+    data.results = (float*)malloc(size * sizeof(float));
+    data.live = (void**)malloc(BENCH_ARENA_LIVE * sizeof(void*));
+    arenaMemory = malloc(BENCH_ARENA_SIZE);
+    output = fopen(outputPath, "w");
+
+    if(!input || !data.work || !data.sorted || !data.ulongs || !data.floats ||
+        !data.results || !data.live || !arenaMemory || !output ||
+        vlarena_init(&data.arena, arenaMemory, BENCH_ARENA_SIZE,
+            vlarena_FirstFit) != 0)
+        return 1;
+
+    fprintf(output, "{\n  \"size\": %lu,\n  \"repetitions\": %d,\n"
+                    "  \"warmup\": %d,\n  \"results\": [",
+        (unsigned long)size, repetitions, BENCH_WARMUP);
+
+    printf("%-26s %-11s %9s %12s %12s %14s\n", "kernel", "input", "size",
+        "median ns", "p95 ns", "per second");
+
+    for(d = 0; d < BenchDistributionCount; ++d)
+    {
+        if(benchFill(input, size, (BenchDistribution)d) != 0) return 1;
+
+        memcpy(data.sorted, input, size * sizeof(int));
+        qsort(data.sorted, size, sizeof(int), &benchCompareInts);
+
+        for(k = 0; k < VL_GET_ARRAY_SIZE(benchKernels); ++k)
+        {
+            const BenchKernel* kernel = &benchKernels[k];
+            double median, p95;
+
+            data.size = kernel->maxSize != 0 && kernel->maxSize < size
+                            ? kernel->maxSize
+                            : size;
+
+            benchRun(kernel, &data, repetitions, samples, &median, &p95);
+
+            printf("%-26s %-11s %9lu %12.3f %12.3f %14.0f\n", kernel->name,
+                benchDistributionNames[d], (unsigned long)data.size, median,
+                p95, 1e9 / median);
+
+            fprintf(output,
+                "%s\n    {\"kernel\": \"%s\", \"category\": \"%s\", "
+                "\"distribution\": \"%s\", \"size\": %lu, \"unit\": \"%s\", "
+                "\"median_ns\": %.4f, \"p95_ns\": %.4f, \"per_second\": %.0f}",
+                first ? "" : ",", kernel->name, kernel->category,
+                benchDistributionNames[d], (unsigned long)data.size,
+                kernel->unit, median, p95, 1e9 / median);
+            first = 0;
+        }
+
+        // Counters of the distribution, when built with VL_PERF
+        VLPERF_DUMP_TABLE(stdout);
+        VLPERF_RESET();
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+    fclose(output);
+
+    free(input);
+    free(data.work);
+    free(data.sorted);
+    free(data.ulongs);
+    free(data.floats);
+    free(data.results);
+    free(data.live);
+    free(arenaMemory);
+    return 0;
+}
@@ -27,6 +27,93 @@ typedef int bool;
         }                                          \
     } while(false);
 
+// Performance counter scopes, enabled by defining VL_PERF (otherwise they
+// expand to nothing). A scope name must be a valid identifier, unique in its
+// block; scopes with the same name are aggregated together:
+//     VLPERF_BEGIN(sort);
+//     vla_sortShellI(array, size, NULL);
+//     VLPERF_END(sort);
+//     ...
+//     VLPERF_DUMP_TABLE(stdout);
+// See Global/Perf.h for the counters measured.
+#ifdef VL_PERF
+#define VLPERF_BEGIN(mName)                    \
+    static int vlperf_id_##mName = -1;         \
+    VlPerfSample vlperf_sample_##mName;        \
+    vlperf_begin(&vlperf_id_##mName, #mName, &vlperf_sample_##mName)
+#define VLPERF_END(mName) vlperf_end(vlperf_id_##mName, &vlperf_sample_##mName)
+#define VLPERF_DUMP_TABLE(mFile) vlperf_dumpTable(mFile)
+#define VLPERF_DUMP_JSON(mFile) vlperf_dumpJson(mFile)
+#define VLPERF_RESET() vlperf_reset()
+#else
+#define VLPERF_BEGIN(mName) ((void)0)
+#define VLPERF_END(mName) ((void)0)
+#define VLPERF_DUMP_TABLE(mFile) ((void)0)
+#define VLPERF_DUMP_JSON(mFile) ((void)0)
+#define VLPERF_RESET() ((void)0)
+#endif
+
+// Storage class of variables with a copy per thread
+#if defined(_MSC_VER)
+#define VL_THREAD_LOCAL __declspec(thread)
+#else
+#define VL_THREAD_LOCAL __thread
+#endif
+
+// Operation counters, enabled by defining VL_COUNT_OPS. Instrumented
+// algorithms count comparisons, swaps, moves (element copies), probes
+// (elements inspected by searches) and visits (tree nodes) into
+// thread-local counters:
+//     vlops_reset();
+//     vla_sortShellI(array, size, NULL);
+//     printf("%llu comparisons\n", vlops_get().comparisons);
+// The counters are a single object per program: exactly one translation
+// unit must also define VL_COUNT_OPS_IMPL before including VeeLib.
+// Otherwise VL_OPS_CMP(x) expands to (x) and the other macros to nothing,
+// so the generated code does not change, and vlops_get returns zeros.
+typedef struct
+{
+    unsigned long long comparisons, swaps, moves, probes, visits;
+} VlOps;
+
+#ifdef VL_COUNT_OPS
+extern VL_THREAD_LOCAL VlOps vlops_counts;
+
+#ifdef VL_COUNT_OPS_IMPL
+VL_THREAD_LOCAL VlOps vlops_counts;
+#endif
+
+#define VL_OPS_CMP(mExpr) (++vlops_counts.comparisons, (mExpr))
+#define VL_OPS_SWAP() (++vlops_counts.swaps)
+#define VL_OPS_MOVE(mCount) (vlops_counts.moves += (mCount))
+#define VL_OPS_PROBE() (++vlops_counts.probes)
+#define VL_OPS_VISIT() (++vlops_counts.visits)
+
+/// @brief Clears the operation counters of the calling thread.
+static inline void vlops_reset()
+{
+    VlOps zero = {0, 0, 0, 0, 0};
+    vlops_counts = zero;
+}
+
+/// @brief Returns the operation counters of the calling thread.
+static inline VlOps vlops_get() { return vlops_counts; }
+#else
+#define VL_OPS_CMP(mExpr) (mExpr)
+#define VL_OPS_SWAP() ((void)0)
+#define VL_OPS_MOVE(mCount) ((void)0)
+#define VL_OPS_PROBE() ((void)0)
+#define VL_OPS_VISIT() ((void)0)
+
+static inline void vlops_reset() {}
+
+static inline VlOps vlops_get()
+{
+    VlOps zero = {0, 0, 0, 0, 0};
+    return zero;
+}
+#endif
+
 #if(__linux || __unix || __posix)
 #define VL_OS_LINUX
 #elif(_WIN64 || _WIN32)
@@ -45,6 +132,12 @@ typedef int ArrayIdx;
 //		vlm_:		math functions
 //		vlc_:		console functions
 //		vla_:		array functions
+//		vlpoly_:	polynomial and elementary functions
+//		vlperf_:	performance counters (Global/Perf.h)
+//		vlops_:		operation counters
+//		vlarena_:	fixed arena allocator
+//		vlalloc_:	allocator interface, thread-caching allocator
+//		vlv_:		growable vectors
 //		vldpr_:		deprecated functions
 
 //	Suffixes:
@@ -53,4 +146,8 @@ typedef int ArrayIdx;
 //		F:			float
 //		D:			double
 
+#ifdef VL_PERF
+#include "VeeLib/Global/Perf.h"
+#endif
+
 #endif
@@ -0,0 +1,317 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_GLOBAL_PERF
+#define VL_GLOBAL_PERF
+
+// Implementation of the VLPERF_ instrumentation macros (see Common.h),
+// included only when VL_PERF is defined.
+// On Linux, hardware counters are read through perf_event_open as a single
+// group (cycles, instructions, L1 data cache read misses, last level cache
+// misses and branch misses), counting user space only for the calling
+// thread. When the counters cannot be opened (no kernel support, or
+// forbidden by perf_event_paranoid), only cycles are measured, with rdtsc.
+// Scope aggregates are kept per translation unit and are not thread-safe.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef VL_OS_LINUX
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Not declared by unistd.h in strict C99 mode
+long syscall(long mNumber, ...);
+#endif
+
+// Max number of distinct scopes
+#define VLPERF_MAX_SCOPES 64
+
+typedef enum
+{
+    vlperf_Cycles,
+    vlperf_Instructions,
+    vlperf_L1Misses,
+    vlperf_LLCMisses,
+    vlperf_BranchMisses,
+    vlperf_CounterCount
+} VlPerfCounter;
+
+static const char* vlperf_counterNames[vlperf_CounterCount] = {
+    "cycles", "instructions", "l1_misses", "llc_misses", "branch_misses"};
+
+/// @brief Counter values at the beginning of a scope.
+typedef struct
+{
+    unsigned long long values[vlperf_CounterCount];
+} VlPerfSample;
+
+/// @brief Aggregates of all the executions of a scope.
+typedef struct
+{
+    const char* name;
+    unsigned long long calls;
+    unsigned long long totals[vlperf_CounterCount];
+    unsigned long long minCycles, maxCycles;
+} VlPerfScope;
+
+/// @brief State of the counters, shared by all the scopes.
+/// @details `fds[c]` is the descriptor of counter c, -1 if it is not
+/// available; `slots[c]` is its position in a group read.
+typedef struct
+{
+    bool initialized, hardware;
+    int fds[vlperf_CounterCount];
+    int slots[vlperf_CounterCount];
+    int slotCount;
+    VlPerfScope scopes[VLPERF_MAX_SCOPES];
+    int scopeCount;
+} VlPerfState;
+
+static VlPerfState vlperf_state;
+
+/// @brief Reads the time stamp counter, or a nanosecond clock where there
+/// is none.
+static inline unsigned long long vlperf_rdtsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    return (unsigned long long)clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif
+}
+
+#ifdef VL_OS_LINUX
+static inline int vlperf_impl_open(
+    unsigned int mType, unsigned long long mConfig, int mGroupFd)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = mType;
+    attr.config = mConfig;
+    attr.disabled = mGroupFd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, mGroupFd, 0);
+}
+#endif
+
+/// @brief Opens the counters. Called by the first scope.
+static inline void vlperf_init()
+{
+    int c;
+
+    vlperf_state.initialized = true;
+    vlperf_state.hardware = false;
+    vlperf_state.slotCount = 0;
+    for(c = 0; c < vlperf_CounterCount; ++c) vlperf_state.fds[c] = -1;
+
+#ifdef VL_OS_LINUX
+    {
+        static const unsigned int types[vlperf_CounterCount] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+        static const unsigned long long configs[vlperf_CounterCount] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+        // Cycles lead the group: without them, rdtsc is used
+        vlperf_state.fds[0] = vlperf_impl_open(types[0], configs[0], -1);
+        if(vlperf_state.fds[0] == -1) return;
+
+        vlperf_state.slots[0] = vlperf_state.slotCount++;
+        for(c = 1; c < vlperf_CounterCount; ++c)
+        {
+            vlperf_state.fds[c] =
+                vlperf_impl_open(types[c], configs[c], vlperf_state.fds[0]);
+            if(vlperf_state.fds[c] != -1)
+                vlperf_state.slots[c] = vlperf_state.slotCount++;
+        }
+
+        ioctl(vlperf_state.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        vlperf_state.hardware = true;
+    }
+#endif
+}
+
+/// @brief Writes the current values of all the counters in mSample.
+/// @details Unavailable counters read as 0.
+static inline void vlperf_read(VlPerfSample* mSample)
+{
+    int c;
+
+#ifdef VL_OS_LINUX
+    if(vlperf_state.hardware)
+    {
+        // Group read: number of counters, then their values
+        unsigned long long buffer[1 + vlperf_CounterCount];
+        ssize_t size = (ssize_t)((1 + vlperf_state.slotCount) * sizeof(buffer[0]));
+
+        if(read(vlperf_state.fds[0], buffer, size) == size)
+        {
+            for(c = 0; c < vlperf_CounterCount; ++c)
+                mSample->values[c] = vlperf_state.fds[c] != -1
+                                         ? buffer[1 + vlperf_state.slots[c]]
+                                         : 0;
+            return;
+        }
+    }
+#endif
+
+    for(c = 0; c < vlperf_CounterCount; ++c) mSample->values[c] = 0;
+    mSample->values[vlperf_Cycles] = vlperf_rdtsc();
+}
+
+/// @brief Clears the aggregates of mScope, keeping its name.
+static inline void vlperf_impl_clear(VlPerfScope* mScope)
+{
+    const char* name = mScope->name;
+
+    memset(mScope, 0, sizeof(*mScope));
+    mScope->name = name;
+    mScope->minCycles = (unsigned long long)-1;
+}
+
+/// @brief Returns the index of the scope called mName, registering it if it
+/// is new (-1 if there are already VLPERF_MAX_SCOPES scopes).
+static inline int vlperf_register(const char* mName)
+{
+    VlPerfScope* scope;
+    int i;
+
+    for(i = 0; i < vlperf_state.scopeCount; ++i)
+        if(strcmp(vlperf_state.scopes[i].name, mName) == 0) return i;
+
+    if(vlperf_state.scopeCount == VLPERF_MAX_SCOPES) return -1;
+
+    scope = &vlperf_state.scopes[vlperf_state.scopeCount];
+    scope->name = mName;
+    vlperf_impl_clear(scope);
+
+    return vlperf_state.scopeCount++;
+}
+
+/// @brief Beginning of a scope: mId caches the index of the scope between
+/// calls from the same place.
+static inline void vlperf_begin(int* mId, const char* mName, VlPerfSample* mSample)
+{
+    if(!vlperf_state.initialized) vlperf_init();
+    if(*mId == -1) *mId = vlperf_register(mName);
+
+    vlperf_read(mSample);
+}
+
+/// @brief End of a scope: adds the counter deltas since mSample to the
+/// aggregates of scope mId.
+static inline void vlperf_end(int mId, const VlPerfSample* mSample)
+{
+    VlPerfSample now;
+    VlPerfScope* scope;
+    unsigned long long cycles;
+    int c;
+
+    vlperf_read(&now);
+    if(mId == -1) return;
+
+    scope = &vlperf_state.scopes[mId];
+    ++scope->calls;
+
+    for(c = 0; c < vlperf_CounterCount; ++c)
+        scope->totals[c] += now.values[c] - mSample->values[c];
+
+    cycles = now.values[vlperf_Cycles] - mSample->values[vlperf_Cycles];
+    if(cycles < scope->minCycles) scope->minCycles = cycles;
+    if(cycles > scope->maxCycles) scope->maxCycles = cycles;
+}
+
+/// @brief Clears the aggregates of all the scopes.
+/// @details Scopes stay registered, since every VLPERF_BEGIN caches the
+/// index of its scope.
+static inline void vlperf_reset()
+{
+    int i;
+
+    for(i = 0; i < vlperf_state.scopeCount; ++i)
+        vlperf_impl_clear(&vlperf_state.scopes[i]);
+}
+
+/// @brief Prints the per-call averages of every scope as a table.
+/// @details Counters that are not available are printed as "-".
+static inline void vlperf_dumpTable(FILE* mFile)
+{
+    int i, c;
+
+    fprintf(mFile, "%-24s %10s", "scope", "calls");
+    for(c = 0; c < vlperf_CounterCount; ++c)
+        fprintf(mFile, " %14s", vlperf_counterNames[c]);
+    fprintf(mFile, " %6s\n", "ipc");
+
+    for(i = 0; i < vlperf_state.scopeCount; ++i)
+    {
+        const VlPerfScope* scope = &vlperf_state.scopes[i];
+        double calls = scope->calls > 0 ? (double)scope->calls : 1.0;
+
+        fprintf(mFile, "%-24s %10llu", scope->name, scope->calls);
+
+        for(c = 0; c < vlperf_CounterCount; ++c)
+            if(c == vlperf_Cycles || vlperf_state.fds[c] != -1)
+                fprintf(mFile, " %14.1f", scope->totals[c] / calls);
+            else
+                fprintf(mFile, " %14s", "-");
+
+        if(vlperf_state.fds[vlperf_Instructions] != -1 &&
+            scope->totals[vlperf_Cycles] > 0)
+            fprintf(mFile, " %6.2f\n", (double)scope->totals[vlperf_Instructions] /
+                                           scope->totals[vlperf_Cycles]);
+        else
+            fprintf(mFile, " %6s\n", "-");
+    }
+
+    fprintf(mFile, "(%s)\n", vlperf_state.hardware
+                                 ? "perf_event_open counters"
+                                 : "rdtsc only: hardware counters unavailable");
+}
+
+/// @brief Writes the totals of every scope as JSON.
+/// @details Counters that are not available are written as null.
+static inline void vlperf_dumpJson(FILE* mFile)
+{
+    int i, c;
+
+    fprintf(mFile, "{\n  \"source\": \"%s\",\n  \"scopes\": [",
+        vlperf_state.hardware ? "perf_event_open" : "rdtsc");
+
+    for(i = 0; i < vlperf_state.scopeCount; ++i)
+    {
+        const VlPerfScope* scope = &vlperf_state.scopes[i];
+
+        fprintf(mFile, "%s\n    {\"name\": \"%s\", \"calls\": %llu",
+            i > 0 ? "," : "", scope->name, scope->calls);
+
+        for(c = 0; c < vlperf_CounterCount; ++c)
+            if(c == vlperf_Cycles || vlperf_state.fds[c] != -1)
+                fprintf(mFile, ", \"%s\": %llu", vlperf_counterNames[c],
+                    scope->totals[c]);
+            else
+                fprintf(mFile, ", \"%s\": null", vlperf_counterNames[c]);
+
+        fprintf(mFile, ", \"min_cycles\": %llu, \"max_cycles\": %llu}",
+            scope->calls > 0 ? scope->minCycles : 0, scope->maxCycles);
+    }
+
+    fprintf(mFile, "\n  ]\n}\n");
+}
+
+#endif
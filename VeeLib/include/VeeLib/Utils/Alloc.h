@@ -0,0 +1,342 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_UTILS_ALLOC
+#define VL_UTILS_ALLOC
+
+#include "VeeLib/Global/Common.h"
+#include "VeeLib/Utils/Allocator.h"
+
+// Thread-caching allocator for small objects, also available as the
+// VlAllocator returned by vlalloc_slab (see Utils/Allocator.h).
+//
+// VeeLib.h does not include this header, so that only its users include
+// pthread.h. Its state is a single object per program: exactly one
+// translation unit must define VLALLOC_IMPL before including it:
+//     #define VLALLOC_IMPL
+//     #include <VeeLib/Utils/Alloc.h>
+//
+// The slab allocator (vlalloc_alloc, vlalloc_free) rounds requests up to
+// one of VLALLOC_CLASSES size classes, up to VLALLOC_MAX_SIZE bytes; larger
+// requests go to malloc. Each thread keeps a list of free objects for every
+// class, so most allocations and frees touch no lock and no shared memory.
+// An empty list is refilled with a batch of objects taken from the central
+// pool of the class, and a list that grows past two batches gives one back:
+// the pool lock is taken once per batch, and memory freed by a thread can
+// be reused by the others. When the pool is empty a batch is carved from
+// the current slab of the class, a VLALLOC_SLAB bytes region cut from a
+// VLALLOC_CHUNK bytes chunk obtained with malloc.
+//
+// Memory is never given back to the system: a thread returns its lists to
+// the pools when it exits (or calls vlalloc_flush), and chunks live until
+// the process exits. The thread caches need POSIX threads: on other systems
+// vlalloc_alloc and vlalloc_free call malloc and free.
+
+// Largest size served by the size classes
+#define VLALLOC_MAX_SIZE 1024
+
+// Number of size classes
+#define VLALLOC_CLASSES 20
+
+// Size of the regions from which objects of a class are carved
+#define VLALLOC_SLAB ((size_t)64 << 10)
+
+// Size of the blocks requested to malloc, split in slabs
+#define VLALLOC_CHUNK ((size_t)2 << 20)
+
+// Bytes moved between a thread cache and the pool at once: batches hold
+// this many bytes, but at least 4 and at most 64 objects
+#define VLALLOC_BATCH_BYTES 8192
+
+static const unsigned short vlalloc_impl_sizes[VLALLOC_CLASSES] = {16, 32,
+    48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640,
+    768, 896, 1024};
+
+// Objects in a batch of each class: VLALLOC_BATCH_BYTES / size, clamped
+static const unsigned char vlalloc_impl_batches[VLALLOC_CLASSES] = {64, 64,
+    64, 64, 64, 64, 64, 64, 51, 42, 36, 32, 25, 21, 18, 16, 12, 10, 9, 8};
+
+// Class of each size, indexed by the size in 16 bytes units rounded up
+static const unsigned char vlalloc_impl_classes[VLALLOC_MAX_SIZE / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 12, 12, 13,
+    13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 16, 16, 16, 16,
+    17, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19,
+    19, 19, 19, 19, 19};
+
+/// @brief Returns the size class of mSize bytes (at most VLALLOC_MAX_SIZE).
+static inline unsigned int vlalloc_getClass(size_t mSize)
+{
+    return vlalloc_impl_classes[(mSize + 15) >> 4];
+}
+
+/// @brief Returns the number of bytes actually reserved for mSize bytes.
+static inline size_t vlalloc_getUsableSize(size_t mSize)
+{
+    if(mSize > VLALLOC_MAX_SIZE) return mSize;
+    return vlalloc_impl_sizes[vlalloc_getClass(mSize)];
+}
+
+#ifdef VL_OS_LINUX
+#include <pthread.h>
+
+// Objects of a class linked through their first word
+typedef struct
+{
+    void* head;
+    unsigned int count;
+} VlAllocList;
+
+// Central pool of a class: batches of free objects, each one linked through
+// the first word of its objects, linked together through the second word
+// of their first object; then the unused part of the current slab
+typedef struct
+{
+    pthread_mutex_t mutex;
+    void* batches;
+    char* slab;
+    char* slabEnd;
+} VlAllocPool;
+
+extern VL_THREAD_LOCAL VlAllocList vlalloc_impl_cache[VLALLOC_CLASSES];
+extern VL_THREAD_LOCAL int vlalloc_impl_registered;
+
+extern VlAllocPool vlalloc_impl_pools[VLALLOC_CLASSES];
+extern pthread_mutex_t vlalloc_impl_chunkMutex;
+extern char* vlalloc_impl_chunk;
+extern char* vlalloc_impl_chunkEnd;
+extern pthread_once_t vlalloc_impl_once;
+extern pthread_key_t vlalloc_impl_key;
+
+#ifdef VLALLOC_IMPL
+VL_THREAD_LOCAL VlAllocList vlalloc_impl_cache[VLALLOC_CLASSES];
+VL_THREAD_LOCAL int vlalloc_impl_registered;
+
+VlAllocPool vlalloc_impl_pools[VLALLOC_CLASSES];
+pthread_mutex_t vlalloc_impl_chunkMutex = PTHREAD_MUTEX_INITIALIZER;
+char* vlalloc_impl_chunk;
+char* vlalloc_impl_chunkEnd;
+pthread_once_t vlalloc_impl_once = PTHREAD_ONCE_INIT;
+pthread_key_t vlalloc_impl_key;
+#endif
+
+static inline unsigned int vlalloc_impl_batch(unsigned int mClass)
+{
+    return vlalloc_impl_batches[mClass];
+}
+
+static inline void** vlalloc_impl_link(void* mObject)
+{
+    return (void**)mObject;
+}
+
+// Gives mCount objects of mList back to the pool of mClass
+static inline void vlalloc_impl_drain(
+    VlAllocList* mList, unsigned int mClass, unsigned int mCount)
+{
+    VlAllocPool* pool = &vlalloc_impl_pools[mClass];
+    void* batch = mList->head;
+    void* last = batch;
+    unsigned int i;
+
+    for(i = 1; i < mCount; ++i) last = *vlalloc_impl_link(last);
+    mList->head = *vlalloc_impl_link(last);
+    mList->count -= mCount;
+    *vlalloc_impl_link(last) = NULL;
+
+    pthread_mutex_lock(&pool->mutex);
+    vlalloc_impl_link(batch)[1] = pool->batches;
+    pool->batches = batch;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/// @brief Gives the objects cached by the calling thread back to the pools,
+/// where the other threads can reuse them.
+static inline void vlalloc_flush()
+{
+    unsigned int i;
+
+    for(i = 0; i < VLALLOC_CLASSES; ++i)
+        if(vlalloc_impl_cache[i].count > 0)
+            vlalloc_impl_drain(
+                &vlalloc_impl_cache[i], i, vlalloc_impl_cache[i].count);
+}
+
+static inline void vlalloc_impl_threadExit(void* mValue)
+{
+    (void)mValue;
+    vlalloc_flush();
+}
+
+static inline void vlalloc_impl_init()
+{
+    unsigned int i;
+
+    for(i = 0; i < VLALLOC_CLASSES; ++i)
+        pthread_mutex_init(&vlalloc_impl_pools[i].mutex, NULL);
+    pthread_key_create(&vlalloc_impl_key, vlalloc_impl_threadExit);
+}
+
+// Makes the cache of the calling thread flushed when the thread exits
+static inline void vlalloc_impl_register()
+{
+    pthread_once(&vlalloc_impl_once, vlalloc_impl_init);
+    pthread_setspecific(vlalloc_impl_key, &vlalloc_impl_registered);
+    vlalloc_impl_registered = 1;
+}
+
+// Returns a new slab, or NULL if malloc fails
+static inline char* vlalloc_impl_newSlab()
+{
+    char* result = NULL;
+
+    pthread_mutex_lock(&vlalloc_impl_chunkMutex);
+    if(vlalloc_impl_chunk == vlalloc_impl_chunkEnd)
+    {
+        vlalloc_impl_chunk = (char*)malloc(VLALLOC_CHUNK);
+        vlalloc_impl_chunkEnd = vlalloc_impl_chunk;
+        if(vlalloc_impl_chunk != NULL) vlalloc_impl_chunkEnd += VLALLOC_CHUNK;
+    }
+    if(vlalloc_impl_chunk != vlalloc_impl_chunkEnd)
+    {
+        result = vlalloc_impl_chunk;
+        vlalloc_impl_chunk += VLALLOC_SLAB;
+    }
+    pthread_mutex_unlock(&vlalloc_impl_chunkMutex);
+
+    return result;
+}
+
+// Fills the empty list of mClass with a batch of objects
+// Returns 1 in case of error (out of memory)
+static inline int vlalloc_impl_refill(VlAllocList* mList, unsigned int mClass)
+{
+    VlAllocPool* pool = &vlalloc_impl_pools[mClass];
+    size_t size = vlalloc_impl_sizes[mClass];
+    unsigned int count = vlalloc_impl_batch(mClass);
+    void* head;
+
+    if(!vlalloc_impl_registered) vlalloc_impl_register();
+
+    pthread_mutex_lock(&pool->mutex);
+    head = pool->batches;
+    if(head != NULL)
+    {
+        pool->batches = vlalloc_impl_link(head)[1];
+        pthread_mutex_unlock(&pool->mutex);
+
+        mList->head = head;
+        for(count = 0; head != NULL; head = *vlalloc_impl_link(head)) ++count;
+        mList->count = count;
+        return 0;
+    }
+
+    if(pool->slab == pool->slabEnd)
+    {
+        pool->slab = vlalloc_impl_newSlab();
+        pool->slabEnd = pool->slab;
+        if(pool->slab == NULL)
+        {
+            pthread_mutex_unlock(&pool->mutex);
+            return 1;
+        }
+        pool->slabEnd += VLALLOC_SLAB / size * size;
+    }
+
+    if((size_t)(pool->slabEnd - pool->slab) < count * size)
+        count = (unsigned int)((size_t)(pool->slabEnd - pool->slab) / size);
+    head = pool->slab;
+    pool->slab += count * size;
+    pthread_mutex_unlock(&pool->mutex);
+
+    mList->head = head;
+    mList->count = count;
+    for(; --count > 0; head = (char*)head + size)
+        *vlalloc_impl_link(head) = (char*)head + size;
+    *vlalloc_impl_link(head) = NULL;
+
+    return 0;
+}
+
+/// @brief Allocates mSize bytes, aligned to 16 bytes (or as malloc, for
+/// sizes larger than VLALLOC_MAX_SIZE).
+/// @return Returns NULL if out of memory.
+static inline void* vlalloc_alloc(size_t mSize)
+{
+    unsigned int c;
+    VlAllocList* list;
+    void* result;
+
+    if(mSize > VLALLOC_MAX_SIZE) return malloc(mSize);
+
+    c = vlalloc_getClass(mSize);
+    list = &vlalloc_impl_cache[c];
+    if(list->head == NULL && vlalloc_impl_refill(list, c)) return NULL;
+
+    result = list->head;
+    list->head = *vlalloc_impl_link(result);
+    --list->count;
+
+    return result;
+}
+
+/// @brief Frees memory returned by vlalloc_alloc. mSize must be the size
+/// it was allocated with. Does nothing if mPtr is NULL.
+static inline void vlalloc_free(void* mPtr, size_t mSize)
+{
+    unsigned int c, batch;
+    VlAllocList* list;
+
+    if(mSize > VLALLOC_MAX_SIZE)
+    {
+        free(mPtr);
+        return;
+    }
+    if(mPtr == NULL) return;
+
+    // The block goes into this thread's cache, which must be flushed at
+    // exit even if the thread never allocates
+    if(!vlalloc_impl_registered) vlalloc_impl_register();
+
+    c = vlalloc_getClass(mSize);
+    list = &vlalloc_impl_cache[c];
+    *vlalloc_impl_link(mPtr) = list->head;
+    list->head = mPtr;
+
+    batch = vlalloc_impl_batch(c);
+    if(++list->count >= 2 * batch) vlalloc_impl_drain(list, c, batch);
+}
+#else
+static inline void vlalloc_flush() {}
+
+static inline void* vlalloc_alloc(size_t mSize) { return malloc(mSize); }
+
+static inline void vlalloc_free(void* mPtr, size_t mSize)
+{
+    (void)mSize;
+    free(mPtr);
+}
+#endif
+
+static inline void* vlalloc_impl_slabAlloc(void* mState, size_t mSize)
+{
+    (void)mState;
+    return vlalloc_alloc(mSize);
+}
+
+static inline void vlalloc_impl_slabDealloc(
+    void* mState, void* mPtr, size_t mSize)
+{
+    (void)mState;
+    vlalloc_free(mPtr, mSize);
+}
+
+/// @brief Returns an allocator calling vlalloc_alloc and vlalloc_free.
+static inline VlAllocator vlalloc_slab()
+{
+    VlAllocator result = {
+        vlalloc_impl_slabAlloc, vlalloc_impl_slabDealloc, NULL};
+    return result;
+}
+
+#endif
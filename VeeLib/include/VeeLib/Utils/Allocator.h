@@ -0,0 +1,75 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_UTILS_ALLOCATOR
+#define VL_UTILS_ALLOCATOR
+
+#include "VeeLib/Global/Common.h"
+#include "VeeLib/Utils/Arena.h"
+
+// Allocator interface accepted by VeeLib containers.
+//
+// A VlAllocator is a pair of functions and the state they receive. Memory
+// is freed with the size it was allocated with, so allocators do not need
+// to store it:
+//     VlAllocator a = vlalloc_system();
+//     int* p = a.alloc(a.state, 10 * sizeof(int));
+//     ...
+//     a.dealloc(a.state, p, 10 * sizeof(int));
+//
+// The allocators on malloc and on an arena are defined here. The
+// thread-caching allocator, vlalloc_slab, is in VeeLib/Utils/Alloc.h,
+// which VeeLib.h does not include.
+
+typedef struct
+{
+    void* (*alloc)(void* mState, size_t mSize);
+    void (*dealloc)(void* mState, void* mPtr, size_t mSize);
+    void* state;
+} VlAllocator;
+
+static inline void* vlalloc_impl_systemAlloc(void* mState, size_t mSize)
+{
+    (void)mState;
+    return malloc(mSize);
+}
+
+static inline void vlalloc_impl_systemDealloc(
+    void* mState, void* mPtr, size_t mSize)
+{
+    (void)mState;
+    (void)mSize;
+    free(mPtr);
+}
+
+static inline void* vlalloc_impl_arenaAlloc(void* mState, size_t mSize)
+{
+    return vlarena_alloc((VlArena*)mState, mSize);
+}
+
+static inline void vlalloc_impl_arenaDealloc(
+    void* mState, void* mPtr, size_t mSize)
+{
+    (void)mSize;
+    vlarena_free((VlArena*)mState, mPtr);
+}
+
+/// @brief Returns an allocator calling malloc and free.
+static inline VlAllocator vlalloc_system()
+{
+    VlAllocator result = {
+        vlalloc_impl_systemAlloc, vlalloc_impl_systemDealloc, NULL};
+    return result;
+}
+
+/// @brief Returns an allocator taking memory from mArena, which must
+/// outlive it. The arena is not thread-safe.
+static inline VlAllocator vlalloc_arena(VlArena* mArena)
+{
+    VlAllocator result = {
+        vlalloc_impl_arenaAlloc, vlalloc_impl_arenaDealloc, mArena};
+    return result;
+}
+
+#endif
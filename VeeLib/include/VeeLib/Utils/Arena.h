@@ -0,0 +1,714 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_UTILS_ARENA
+#define VL_UTILS_ARENA
+
+#include "VeeLib/Global/Common.h"
+
+// Allocator of variable size blocks from a caller-provided memory arena,
+// with first-fit, next-fit, best-fit, worst-fit and buddy placement
+// policies.
+//
+// Every block starts with a header holding its size and two flags: whether
+// the block is free and whether the previous block is free. Free blocks
+// also store their size in their last word (boundary tag), so a freed block
+// finds both neighbours in O(1) and is merged with the free ones: two
+// adjacent free blocks never exist.
+//
+// Free blocks are linked, through their own memory, in two treaps (binary
+// search trees balanced by a pseudo-random priority derived from the offset
+// of the block, so that the trees do not depend on where the arena is):
+//      - ordered by address, each node storing the size of the largest
+//        block in its subtree: first-fit and next-fit descend only into
+//        subtrees that contain a large enough block;
+//      - ordered by size (then address): best-fit is a lower bound search,
+//        worst-fit takes the rightmost node.
+// All the policies and all the operations are O(log n) in the number of
+// free blocks.
+//
+// The buddy policy uses the same blocks differently: their sizes are powers
+// of two, and a block of 2^k bytes starts at an offset multiple of 2^k. Its
+// buddy, the other half of the block of 2^(k+1) bytes it was split from, is
+// found by flipping bit k of the offset. Free blocks of each size are kept
+// in a list, and a bitmap of the non-empty lists gives the smallest size
+// that fits with a single ctz. Blocks waste up to half of their size, but
+// allocating and freeing take at most one step per size. Switching to or
+// from the buddy policy requires vlarena_reset.
+
+// Alignment of blocks and of the returned memory
+#define VLARENA_ALIGN 16
+
+// Header size: the payload of a block starts right after it
+#define VLARENA_HEADER VLARENA_ALIGN
+
+// Smallest block: a free block must hold its tree links and its footer
+#define VLARENA_MIN_BLOCK 64
+
+// Orders (log2 of the size) of the buddy blocks
+#define VLARENA_MIN_ORDER 6
+#define VLARENA_MAX_ORDERS (sizeof(size_t) * 8)
+
+// Header flags, stored in the low bits of the size
+#define VLARENA_FREE ((size_t)1)
+#define VLARENA_PREV_FREE ((size_t)2)
+#define VLARENA_FLAGS (VLARENA_FREE | VLARENA_PREV_FREE)
+
+typedef enum
+{
+    vlarena_FirstFit, // Free block with the lowest address
+    vlarena_NextFit,  // As first-fit, starting after the last allocation
+    vlarena_BestFit,  // Smallest free block
+    vlarena_WorstFit, // Largest free block
+    vlarena_Buddy     // Power of two blocks, split and merged in halves
+} VlArenaPolicy;
+
+typedef struct VlArenaBlock VlArenaBlock;
+
+/// @brief Block of an arena.
+/// @details Allocated blocks only use `header`. The other fields, and the
+/// footer in the last word of the block, are only valid in free blocks.
+struct VlArenaBlock
+{
+    size_t header; // Size | flags
+    size_t priority; // Treap priority; only pads the header when allocated
+    VlArenaBlock* addrSx;
+    VlArenaBlock* addrDx;
+    VlArenaBlock* sizeSx;
+    VlArenaBlock* sizeDx;
+    size_t maxSize; // Largest block in the subtree of the address treap
+};
+
+typedef struct
+{
+    char* begin;
+    char* end;
+    VlArenaBlock* addrRoot;
+    VlArenaBlock* sizeRoot;
+    char* rover; // Next-fit starts looking from here
+    VlArenaPolicy policy;
+    size_t usedBlocks, usedBytes, freeBlocks, freeBytes;
+
+    // Buddy policy: free blocks of order k are linked (through addrSx and
+    // addrDx) in buddyLists[k], and bit k of buddyMap is set if there is any
+    VlArenaBlock* buddyLists[VLARENA_MAX_ORDERS];
+    size_t buddyMap;
+    size_t buddySize; // Bytes covered by blocks, a multiple of the smallest
+} VlArena;
+
+static inline size_t vlarena_impl_size(const VlArenaBlock* mB)
+{
+    return mB->header & ~VLARENA_FLAGS;
+}
+
+static inline VlArenaBlock* vlarena_impl_next(
+    const VlArena* mA, VlArenaBlock* mB)
+{
+    char* next = (char*)mB + vlarena_impl_size(mB);
+    return next < mA->end ? (VlArenaBlock*)next : NULL;
+}
+
+static inline unsigned int vlarena_impl_ctz(size_t mX)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll((unsigned long long)mX);
+#else
+    unsigned int result = 0;
+    for(; !(mX & 1); mX >>= 1) ++result;
+    return result;
+#endif
+}
+
+static inline void vlarena_impl_writeFooter(VlArenaBlock* mB)
+{
+    size_t size = vlarena_impl_size(mB);
+    *(size_t*)((char*)mB + size - sizeof(size_t)) = size;
+}
+
+static inline size_t vlarena_impl_priority(const VlArenaBlock* mB)
+{
+    return mB->priority;
+}
+
+static inline size_t vlarena_impl_max(const VlArenaBlock* mB)
+{
+    return mB != NULL ? mB->maxSize : 0;
+}
+
+static inline void vlarena_impl_updateMax(VlArenaBlock* mB)
+{
+    size_t result = vlarena_impl_size(mB);
+    size_t sx = vlarena_impl_max(mB->addrSx), dx = vlarena_impl_max(mB->addrDx);
+
+    if(sx > result) result = sx;
+    if(dx > result) result = dx;
+    mB->maxSize = result;
+}
+
+// Address treap
+
+static inline VlArenaBlock* vlarena_impl_addrInsert(
+    VlArenaBlock* mT, VlArenaBlock* mB)
+{
+    VlArenaBlock* child;
+
+    if(mT == NULL)
+    {
+        mB->addrSx = mB->addrDx = NULL;
+        mB->maxSize = vlarena_impl_size(mB);
+        return mB;
+    }
+
+    if(mB < mT)
+    {
+        mT->addrSx = child = vlarena_impl_addrInsert(mT->addrSx, mB);
+        if(vlarena_impl_priority(child) > vlarena_impl_priority(mT))
+        {
+            mT->addrSx = child->addrDx;
+            child->addrDx = mT;
+            vlarena_impl_updateMax(mT);
+            vlarena_impl_updateMax(child);
+            return child;
+        }
+    }
+    else
+    {
+        mT->addrDx = child = vlarena_impl_addrInsert(mT->addrDx, mB);
+        if(vlarena_impl_priority(child) > vlarena_impl_priority(mT))
+        {
+            mT->addrDx = child->addrSx;
+            child->addrSx = mT;
+            vlarena_impl_updateMax(mT);
+            vlarena_impl_updateMax(child);
+            return child;
+        }
+    }
+
+    vlarena_impl_updateMax(mT);
+    return mT;
+}
+
+// Joins two treaps, every block of mSx preceding every block of mDx
+static inline VlArenaBlock* vlarena_impl_addrJoin(
+    VlArenaBlock* mSx, VlArenaBlock* mDx)
+{
+    if(mSx == NULL) return mDx;
+    if(mDx == NULL) return mSx;
+
+    if(vlarena_impl_priority(mSx) > vlarena_impl_priority(mDx))
+    {
+        mSx->addrDx = vlarena_impl_addrJoin(mSx->addrDx, mDx);
+        vlarena_impl_updateMax(mSx);
+        return mSx;
+    }
+
+    mDx->addrSx = vlarena_impl_addrJoin(mSx, mDx->addrSx);
+    vlarena_impl_updateMax(mDx);
+    return mDx;
+}
+
+static inline VlArenaBlock* vlarena_impl_addrRemove(
+    VlArenaBlock* mT, VlArenaBlock* mB)
+{
+    if(mT == mB) return vlarena_impl_addrJoin(mT->addrSx, mT->addrDx);
+
+    if(mB < mT)
+        mT->addrSx = vlarena_impl_addrRemove(mT->addrSx, mB);
+    else
+        mT->addrDx = vlarena_impl_addrRemove(mT->addrDx, mB);
+
+    vlarena_impl_updateMax(mT);
+    return mT;
+}
+
+// Size treap
+
+static inline bool vlarena_impl_sizeLess(
+    const VlArenaBlock* mX, const VlArenaBlock* mY)
+{
+    size_t x = vlarena_impl_size(mX), y = vlarena_impl_size(mY);
+    return x < y || (x == y && mX < mY);
+}
+
+static inline VlArenaBlock* vlarena_impl_sizeInsert(
+    VlArenaBlock* mT, VlArenaBlock* mB)
+{
+    VlArenaBlock* child;
+
+    if(mT == NULL)
+    {
+        mB->sizeSx = mB->sizeDx = NULL;
+        return mB;
+    }
+
+    if(vlarena_impl_sizeLess(mB, mT))
+    {
+        mT->sizeSx = child = vlarena_impl_sizeInsert(mT->sizeSx, mB);
+        if(vlarena_impl_priority(child) > vlarena_impl_priority(mT))
+        {
+            mT->sizeSx = child->sizeDx;
+            child->sizeDx = mT;
+            return child;
+        }
+    }
+    else
+    {
+        mT->sizeDx = child = vlarena_impl_sizeInsert(mT->sizeDx, mB);
+        if(vlarena_impl_priority(child) > vlarena_impl_priority(mT))
+        {
+            mT->sizeDx = child->sizeSx;
+            child->sizeSx = mT;
+            return child;
+        }
+    }
+
+    return mT;
+}
+
+static inline VlArenaBlock* vlarena_impl_sizeJoin(
+    VlArenaBlock* mSx, VlArenaBlock* mDx)
+{
+    if(mSx == NULL) return mDx;
+    if(mDx == NULL) return mSx;
+
+    if(vlarena_impl_priority(mSx) > vlarena_impl_priority(mDx))
+    {
+        mSx->sizeDx = vlarena_impl_sizeJoin(mSx->sizeDx, mDx);
+        return mSx;
+    }
+
+    mDx->sizeSx = vlarena_impl_sizeJoin(mSx, mDx->sizeSx);
+    return mDx;
+}
+
+static inline VlArenaBlock* vlarena_impl_sizeRemove(
+    VlArenaBlock* mT, VlArenaBlock* mB)
+{
+    if(mT == mB) return vlarena_impl_sizeJoin(mT->sizeSx, mT->sizeDx);
+
+    if(vlarena_impl_sizeLess(mB, mT))
+        mT->sizeSx = vlarena_impl_sizeRemove(mT->sizeSx, mB);
+    else
+        mT->sizeDx = vlarena_impl_sizeRemove(mT->sizeDx, mB);
+
+    return mT;
+}
+
+// Free block bookkeeping: a block must be removed before its size changes
+
+static inline void vlarena_impl_insertFree(VlArena* mA, VlArenaBlock* mB)
+{
+    unsigned long long x = (unsigned long long)((char*)mB - mA->begin);
+
+    x = x / VLARENA_ALIGN * 0x9E3779B97F4A7C15ULL;
+    mB->priority = (size_t)(x ^ (x >> 29));
+
+    mA->addrRoot = vlarena_impl_addrInsert(mA->addrRoot, mB);
+    mA->sizeRoot = vlarena_impl_sizeInsert(mA->sizeRoot, mB);
+    ++mA->freeBlocks;
+    mA->freeBytes += vlarena_impl_size(mB);
+}
+
+static inline void vlarena_impl_removeFree(VlArena* mA, VlArenaBlock* mB)
+{
+    mA->addrRoot = vlarena_impl_addrRemove(mA->addrRoot, mB);
+    mA->sizeRoot = vlarena_impl_sizeRemove(mA->sizeRoot, mB);
+    --mA->freeBlocks;
+    mA->freeBytes -= vlarena_impl_size(mB);
+}
+
+// Placement policies: each returns a free block of at least mSize bytes,
+// or NULL
+
+static inline VlArenaBlock* vlarena_impl_firstFit(
+    VlArenaBlock* mT, size_t mSize)
+{
+    if(vlarena_impl_max(mT) < mSize) return NULL;
+
+    // The subtree of mT contains a large enough block: it is in the left
+    // subtree if that has one, otherwise it is mT or in the right subtree
+    while(true)
+    {
+        VL_OPS_VISIT();
+
+        if(vlarena_impl_max(mT->addrSx) >= mSize)
+            mT = mT->addrSx;
+        else if(vlarena_impl_size(mT) >= mSize)
+            return mT;
+        else
+            mT = mT->addrDx;
+    }
+}
+
+// First fit among the blocks ending after mRover (the rover can be inside a
+// free block, after coalescing)
+static inline VlArenaBlock* vlarena_impl_nextFit(
+    VlArenaBlock* mT, size_t mSize, const char* mRover)
+{
+    VlArenaBlock* result;
+
+    if(vlarena_impl_max(mT) < mSize) return NULL;
+    VL_OPS_VISIT();
+
+    if((char*)mT + vlarena_impl_size(mT) <= mRover)
+        return vlarena_impl_nextFit(mT->addrDx, mSize, mRover);
+
+    result = vlarena_impl_nextFit(mT->addrSx, mSize, mRover);
+    if(result != NULL) return result;
+    if(vlarena_impl_size(mT) >= mSize) return mT;
+
+    return vlarena_impl_firstFit(mT->addrDx, mSize);
+}
+
+static inline VlArenaBlock* vlarena_impl_bestFit(VlArenaBlock* mT, size_t mSize)
+{
+    VlArenaBlock* result = NULL;
+
+    while(mT != NULL)
+    {
+        VL_OPS_VISIT();
+
+        if(vlarena_impl_size(mT) >= mSize)
+        {
+            result = mT;
+            mT = mT->sizeSx;
+        }
+        else
+            mT = mT->sizeDx;
+    }
+
+    return result;
+}
+
+static inline VlArenaBlock* vlarena_impl_worstFit(
+    VlArenaBlock* mT, size_t mSize)
+{
+    if(mT == NULL) return NULL;
+
+    while(mT->sizeDx != NULL)
+    {
+        VL_OPS_VISIT();
+        mT = mT->sizeDx;
+    }
+
+    return vlarena_impl_size(mT) >= mSize ? mT : NULL;
+}
+
+// Buddy policy
+
+static inline void vlarena_impl_buddyPush(
+    VlArena* mA, VlArenaBlock* mB, unsigned int mOrder)
+{
+    VlArenaBlock* head = mA->buddyLists[mOrder];
+
+    mB->header = ((size_t)1 << mOrder) | VLARENA_FREE;
+    mB->addrSx = NULL;
+    mB->addrDx = head;
+    if(head != NULL) head->addrSx = mB;
+
+    mA->buddyLists[mOrder] = mB;
+    mA->buddyMap |= (size_t)1 << mOrder;
+    ++mA->freeBlocks;
+    mA->freeBytes += (size_t)1 << mOrder;
+}
+
+static inline void vlarena_impl_buddyUnlink(
+    VlArena* mA, VlArenaBlock* mB, unsigned int mOrder)
+{
+    if(mB->addrSx != NULL)
+        mB->addrSx->addrDx = mB->addrDx;
+    else if((mA->buddyLists[mOrder] = mB->addrDx) == NULL)
+        mA->buddyMap &= ~((size_t)1 << mOrder);
+
+    if(mB->addrDx != NULL) mB->addrDx->addrSx = mB->addrSx;
+
+    --mA->freeBlocks;
+    mA->freeBytes -= (size_t)1 << mOrder;
+}
+
+static inline void vlarena_impl_buddyReset(VlArena* mA)
+{
+    size_t size = (size_t)(mA->end - mA->begin), offset = 0;
+    unsigned int order;
+
+    for(order = 0; order < VLARENA_MAX_ORDERS; ++order)
+        mA->buddyLists[order] = NULL;
+    mA->buddyMap = 0;
+
+    // The arena is covered by the largest blocks that fit, in decreasing
+    // order of size, so that each offset is a multiple of its block size
+    for(order = VLARENA_MAX_ORDERS; order-- > VLARENA_MIN_ORDER;)
+        if(size - offset >= (size_t)1 << order)
+        {
+            vlarena_impl_buddyPush(
+                mA, (VlArenaBlock*)(mA->begin + offset), order);
+            offset += (size_t)1 << order;
+        }
+
+    mA->buddySize = offset;
+}
+
+static inline void* vlarena_impl_buddyAlloc(VlArena* mA, size_t mSize)
+{
+    unsigned int order = VLARENA_MIN_ORDER, found;
+    VlArenaBlock* block;
+    size_t available;
+
+    if(mSize > mA->buddySize) return NULL;
+    while(((size_t)1 << order) - VLARENA_HEADER < mSize) ++order;
+
+    // Lists of blocks at least as large as needed
+    available = mA->buddyMap >> order << order;
+    if(available == 0) return NULL;
+
+    found = vlarena_impl_ctz(available);
+    block = mA->buddyLists[found];
+    vlarena_impl_buddyUnlink(mA, block, found);
+
+    // Split the block in halves until it is small enough: upper halves stay
+    // free
+    while(found > order)
+    {
+        VL_OPS_VISIT();
+        --found;
+        vlarena_impl_buddyPush(
+            mA, (VlArenaBlock*)((char*)block + ((size_t)1 << found)), found);
+    }
+
+    block->header = (size_t)1 << order;
+    ++mA->usedBlocks;
+    mA->usedBytes += (size_t)1 << order;
+
+    return (char*)block + VLARENA_HEADER;
+}
+
+static inline void vlarena_impl_buddyFree(VlArena* mA, VlArenaBlock* mB)
+{
+    size_t offset = (size_t)((char*)mB - mA->begin);
+    unsigned int order = vlarena_impl_ctz(vlarena_impl_size(mB));
+
+    --mA->usedBlocks;
+    mA->usedBytes -= (size_t)1 << order;
+
+    // Merge with the buddy while it is free and not split: a block always
+    // starts at the offset of the buddy, and it is the buddy itself if it
+    // has the same order
+    while(true)
+    {
+        size_t size = (size_t)1 << order, buddyOffset = offset ^ size;
+        VlArenaBlock* buddy = (VlArenaBlock*)(mA->begin + buddyOffset);
+
+        if(buddyOffset + size > mA->buddySize ||
+            buddy->header != (size | VLARENA_FREE))
+            break;
+
+        VL_OPS_VISIT();
+        vlarena_impl_buddyUnlink(mA, buddy, order);
+        offset &= ~size;
+        ++order;
+    }
+
+    vlarena_impl_buddyPush(mA, (VlArenaBlock*)(mA->begin + offset), order);
+}
+
+/// @brief Frees all the blocks of the arena at once.
+static inline void vlarena_reset(VlArena* mA)
+{
+    VlArenaBlock* first = (VlArenaBlock*)mA->begin;
+
+    mA->addrRoot = mA->sizeRoot = NULL;
+    mA->rover = mA->begin;
+    mA->usedBlocks = mA->usedBytes = mA->freeBlocks = mA->freeBytes = 0;
+
+    if(mA->policy == vlarena_Buddy)
+    {
+        vlarena_impl_buddyReset(mA);
+        return;
+    }
+
+    first->header = (size_t)(mA->end - mA->begin) | VLARENA_FREE;
+    vlarena_impl_writeFooter(first);
+    vlarena_impl_insertFree(mA, first);
+}
+
+/// @brief Initializes an allocator managing the mSize bytes at mMemory.
+/// @details The memory is owned by the caller and must outlive the
+/// allocator. The policy can be changed at any time through `policy`, but
+/// the arena must be reset when switching to or from vlarena_Buddy.
+/// @return Returns 1 in case of error (the memory is too small).
+static inline int vlarena_init(
+    VlArena* mA, void* mMemory, size_t mSize, VlArenaPolicy mPolicy)
+{
+    size_t padding =
+        (VLARENA_ALIGN - (size_t)mMemory % VLARENA_ALIGN) % VLARENA_ALIGN;
+
+    if(mSize < padding + VLARENA_MIN_BLOCK) return 1;
+
+    mA->begin = (char*)mMemory + padding;
+    mA->end = mA->begin + ((mSize - padding) & ~(size_t)(VLARENA_ALIGN - 1));
+    mA->policy = mPolicy;
+
+    vlarena_reset(mA);
+    return 0;
+}
+
+/// @brief Allocates mSize bytes, aligned to VLARENA_ALIGN.
+/// @details The block chosen by the policy is split if what remains can
+/// hold another block. Next-fit will continue after this block.
+/// @return Returns NULL if there is no free block large enough.
+static inline void* vlarena_alloc(VlArena* mA, size_t mSize)
+{
+    VlArenaBlock* block;
+    VlArenaBlock* next;
+    size_t size, need;
+
+    if(mA->policy == vlarena_Buddy) return vlarena_impl_buddyAlloc(mA, mSize);
+    if(mSize > (size_t)(mA->end - mA->begin)) return NULL;
+
+    need = (mSize + VLARENA_HEADER + VLARENA_ALIGN - 1) &
+           ~(size_t)(VLARENA_ALIGN - 1);
+    if(need < VLARENA_MIN_BLOCK) need = VLARENA_MIN_BLOCK;
+
+    switch(mA->policy)
+    {
+        case vlarena_NextFit:
+            block = vlarena_impl_nextFit(mA->addrRoot, need, mA->rover);
+            if(block == NULL) block = vlarena_impl_firstFit(mA->addrRoot, need);
+            break;
+        case vlarena_BestFit:
+            block = vlarena_impl_bestFit(mA->sizeRoot, need);
+            break;
+        case vlarena_WorstFit:
+            block = vlarena_impl_worstFit(mA->sizeRoot, need);
+            break;
+        default: block = vlarena_impl_firstFit(mA->addrRoot, need); break;
+    }
+
+    if(block == NULL) return NULL;
+
+    vlarena_impl_removeFree(mA, block);
+    size = vlarena_impl_size(block);
+
+    if(size - need >= VLARENA_MIN_BLOCK)
+    {
+        // The rest of the block stays free
+        VlArenaBlock* rest = (VlArenaBlock*)((char*)block + need);
+        rest->header = (size - need) | VLARENA_FREE;
+        vlarena_impl_writeFooter(rest);
+        vlarena_impl_insertFree(mA, rest);
+        size = need;
+    }
+    else if((next = vlarena_impl_next(mA, block)) != NULL)
+        next->header &= ~VLARENA_PREV_FREE;
+
+    // The previous block is allocated: free blocks are never adjacent
+    block->header = size;
+    ++mA->usedBlocks;
+    mA->usedBytes += size;
+    mA->rover = (char*)block + size;
+
+    return (char*)block + VLARENA_HEADER;
+}
+
+/// @brief Frees memory returned by vlarena_alloc, merging it with the
+/// adjacent free blocks (or with its buddy). Does nothing if mPtr is NULL.
+static inline void vlarena_free(VlArena* mA, void* mPtr)
+{
+    VlArenaBlock* block;
+    VlArenaBlock* next;
+    size_t size;
+
+    if(mPtr == NULL) return;
+
+    block = (VlArenaBlock*)((char*)mPtr - VLARENA_HEADER);
+    assert(!(block->header & VLARENA_FREE));
+
+    if(mA->policy == vlarena_Buddy)
+    {
+        vlarena_impl_buddyFree(mA, block);
+        return;
+    }
+
+    size = vlarena_impl_size(block);
+    --mA->usedBlocks;
+    mA->usedBytes -= size;
+
+    next = vlarena_impl_next(mA, block);
+    if(next != NULL && (next->header & VLARENA_FREE))
+    {
+        vlarena_impl_removeFree(mA, next);
+        size += vlarena_impl_size(next);
+    }
+
+    if(block->header & VLARENA_PREV_FREE)
+    {
+        // The footer of the previous block is right before this block
+        size_t prevSize = *(size_t*)((char*)block - sizeof(size_t));
+        VlArenaBlock* prev = (VlArenaBlock*)((char*)block - prevSize);
+
+        vlarena_impl_removeFree(mA, prev);
+        size += prevSize;
+        block = prev;
+    }
+
+    block->header = size | VLARENA_FREE;
+    vlarena_impl_writeFooter(block);
+    vlarena_impl_insertFree(mA, block);
+
+    next = vlarena_impl_next(mA, block);
+    if(next != NULL) next->header |= VLARENA_PREV_FREE;
+}
+
+/// @brief Returns the size of the largest allocation that can succeed.
+static inline size_t vlarena_getLargestFree(const VlArena* mA)
+{
+    size_t max = vlarena_impl_max(mA->addrRoot);
+
+    if(mA->policy == vlarena_Buddy)
+    {
+        // The highest bit of the map is the size of the largest free blocks
+        for(max = mA->buddyMap; max & (max - 1);) max &= max - 1;
+    }
+
+    return max > VLARENA_HEADER ? max - VLARENA_HEADER : 0;
+}
+
+/// @brief Returns the fragmentation of the arena: the number of times
+/// blocks change from allocated to free or vice versa, in address order.
+/// @details Free blocks are never adjacent, so every free block is counted
+/// once for each neighbour it has: O(log n), finding the last free block.
+/// Buddies can be adjacent: with the buddy policy all the blocks are
+/// walked, O(n).
+static inline size_t vlarena_getFragmentation(const VlArena* mA)
+{
+    const VlArenaBlock* last = mA->addrRoot;
+    size_t result = 2 * mA->freeBlocks;
+
+    if(mA->policy == vlarena_Buddy)
+    {
+        const char* p = mA->begin;
+        const char* end = p + mA->buddySize;
+        size_t lastFree = ((const VlArenaBlock*)p)->header & VLARENA_FREE;
+
+        for(result = 0; p < end; p += vlarena_impl_size((const VlArenaBlock*)p))
+        {
+            size_t isFree = ((const VlArenaBlock*)p)->header & VLARENA_FREE;
+
+            result += isFree != lastFree;
+            lastFree = isFree;
+        }
+
+        return result;
+    }
+
+    if(last == NULL) return 0;
+    while(last->addrDx != NULL) last = last->addrDx;
+
+    if(((const VlArenaBlock*)mA->begin)->header & VLARENA_FREE) --result;
+    if((const char*)last + vlarena_impl_size(last) == mA->end) --result;
+
+    return result;
+}
+
+#endif
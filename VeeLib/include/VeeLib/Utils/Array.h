@@ -16,7 +16,7 @@ inline ArrayIdx vla_getMinValueIdxI(int* mArray, size_t mLB, size_t mUB)
 
     ArrayIdx result;
     for(result = mLB; mLB < mUB; ++mLB)
-        if(mArray[mLB] < mArray[result]) result = mLB;
+        if(VL_OPS_CMP(mArray[mLB] < mArray[result])) result = mLB;
     return result;
 }
 
@@ -27,7 +27,10 @@ inline void vla_sortSelectionI(int* mArray, size_t mSize)
 
     ArrayIdx i;
     for(i = 0; i < mSize - 1; ++i)
+    {
+        VL_OPS_SWAP();
         vlu_swapI(&mArray[vla_getMinValueIdxI(mArray, i, mSize)], &mArray[i]);
+    }
 }
 
 inline void vla_shiftToEndI(int* mArray, size_t mSize, int mIdx)
@@ -36,14 +39,18 @@ inline void vla_shiftToEndI(int* mArray, size_t mSize, int mIdx)
     // array.
 
     ArrayIdx i;
-    for(i = mIdx + 1; i < mSize; ++i) vlu_swapI(&mArray[i], &mArray[i - 1]);
+    for(i = mIdx + 1; i < mSize; ++i)
+    {
+        VL_OPS_SWAP();
+        vlu_swapI(&mArray[i], &mArray[i - 1]);
+    }
 }
 
 inline bool vla_isSortedI(int* mArray, size_t mSize)
 {
     ArrayIdx i;
     for(i = 0; i < mSize - 1; ++i)
-        if(mArray[i] > mArray[i + 1]) return false;
+        if(VL_OPS_CMP(mArray[i] > mArray[i + 1])) return false;
     return true;
 }
 
@@ -53,7 +60,11 @@ inline void vla_uniquifyI(int* mArray, size_t mSize, size_t* mNewSize)
 
     ArrayIdx i, p = 0;
     for(i = 1; i < mSize; ++i)
-        if(mArray[i] != mArray[p]) mArray[++p] = mArray[i];
+        if(VL_OPS_CMP(mArray[i] != mArray[p]))
+        {
+            VL_OPS_MOVE(1);
+            mArray[++p] = mArray[i];
+        }
     *mNewSize = p + 1;
 }
 
@@ -61,7 +72,10 @@ inline ArrayIdx vla_linearSearchI(int* mArray, size_t mSize, int mValue)
 {
     ArrayIdx i;
     for(i = 0; i < mSize; ++i)
-        if(mArray[i] == mValue) return i;
+    {
+        VL_OPS_PROBE();
+        if(VL_OPS_CMP(mArray[i] == mValue)) return i;
+    }
     return -1;
 }
 
@@ -74,10 +88,11 @@ inline ArrayIdx vla_binarySearchI(int* mArray, size_t mSize, int mValue)
     while(lb <= ub)
     {
         mid = (lb + ub) / 2;
+        VL_OPS_PROBE();
 
-        if(mArray[mid] > mValue)
+        if(VL_OPS_CMP(mArray[mid] > mValue))
             ub = mid - 1;
-        else if(mArray[mid] < mValue)
+        else if(VL_OPS_CMP(mArray[mid] < mValue))
             lb = mid + 1;
         else
             return mid;
@@ -86,4 +101,113 @@ inline ArrayIdx vla_binarySearchI(int* mArray, size_t mSize, int mValue)
     return -1;
 }
 
+// Max number of gaps a gap sequence generator can write
+#define VLA_SHELL_MAX_GAPS 64
+
+/// @brief Gap sequence generator for vla_sortShellI.
+/// @details Writes in mGaps, in increasing order and starting from 1, all the
+/// gaps smaller than mSize (at most VLA_SHELL_MAX_GAPS).
+/// @return Returns the number of gaps written.
+typedef size_t (*VlaGapFn)(size_t mSize, size_t* mGaps);
+
+/// @brief Ciura's empirical gaps, extended by multiplying by 2.25.
+/// @details 1, 4, 10, 23, 57, 132, 301, 701, 1750, 3937, 8858, ...
+static inline size_t vla_getGapsCiura(size_t mSize, size_t* mGaps)
+{
+    static const size_t ciura[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+    size_t count = 0, gap;
+
+    while(count < VL_GET_ARRAY_SIZE(ciura) && ciura[count] < mSize)
+    {
+        mGaps[count] = ciura[count];
+        ++count;
+    }
+
+    if(count < VL_GET_ARRAY_SIZE(ciura)) return count;
+
+    for(gap = mGaps[count - 1]; gap <= (size_t)-1 / 9; ++count)
+    {
+        gap = gap * 9 / 4;
+        if(gap >= mSize || count == VLA_SHELL_MAX_GAPS) break;
+        mGaps[count] = gap;
+    }
+
+    return count;
+}
+
+/// @brief Tokuda's gaps: ceil((9^k - 4^k) / (5 * 4^(k - 1))).
+/// @details 1, 4, 9, 20, 46, 103, 233, 525, 1182, 2660, ...
+static inline size_t vla_getGapsTokuda(size_t mSize, size_t* mGaps)
+{
+    // (9^k - 4^k) / (5 * 4^(k - 1)) = 0.8 * (2.25^k - 1)
+    double power = 2.25, gap = 1.0;
+    size_t count = 0;
+
+    while(count < VLA_SHELL_MAX_GAPS && gap < (double)mSize)
+    {
+        mGaps[count++] = (size_t)gap;
+        power *= 2.25;
+        gap = ceil(0.8 * (power - 1.0));
+    }
+
+    return count;
+}
+
+/// @brief Sedgewick's gaps: 1, then 4^k + 3 * 2^(k - 1) + 1.
+/// @details 1, 8, 23, 77, 281, 1073, 4193, 16577, ... O(n^(4/3)) worst case.
+static inline size_t vla_getGapsSedgewick(size_t mSize, size_t* mGaps)
+{
+    size_t count = 0, k;
+
+    if(mSize > 1) mGaps[count++] = 1;
+
+    for(k = 1; k < sizeof(size_t) * 4 && count < VLA_SHELL_MAX_GAPS; ++k)
+    {
+        size_t gap = ((size_t)1 << (2 * k)) + 3 * ((size_t)1 << (k - 1)) + 1;
+        if(gap >= mSize) break;
+        mGaps[count++] = gap;
+    }
+
+    return count;
+}
+
+/// @brief Shell sort with the gaps in mGaps (increasing, starting from 1).
+/// @details Every gap, from the largest to the smallest, h-sorts the array
+/// by insertion: each element is moved back past the greater elements that
+/// are h positions apart. Sorts in place, using no extra memory.
+static inline void vla_sortShellGapsI(
+    int* mArray, size_t mSize, const size_t* mGaps, size_t mGapCount)
+{
+    size_t i, j;
+
+    while(mGapCount-- > 0)
+    {
+        size_t gap = mGaps[mGapCount];
+
+        for(i = gap; i < mSize; ++i)
+        {
+            int value = mArray[i];
+
+            for(j = i; j >= gap && VL_OPS_CMP(mArray[j - gap] > value); j -= gap)
+            {
+                VL_OPS_MOVE(1);
+                mArray[j] = mArray[j - gap];
+            }
+
+            VL_OPS_MOVE(1);
+            mArray[j] = value;
+        }
+    }
+}
+
+/// @brief Shell sort with the gaps generated by mGapFn (Ciura's if NULL).
+static inline void vla_sortShellI(int* mArray, size_t mSize, VlaGapFn mGapFn)
+{
+    size_t gaps[VLA_SHELL_MAX_GAPS];
+    size_t gapCount =
+        (mGapFn != NULL ? mGapFn : &vla_getGapsCiura)(mSize, gaps);
+
+    vla_sortShellGapsI(mArray, mSize, gaps, gapCount);
+}
+
 #endif
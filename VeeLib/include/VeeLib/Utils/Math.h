@@ -7,6 +7,16 @@
 
 #include "VeeLib/Global/Common.h"
 #include "VeeLib/Utils/Utility.h"
+#include <limits.h>
+
+// Largest integers whose square/cube still fit in an unsigned long
+#if ULONG_MAX > 0xFFFFFFFFUL
+#define VLM_ISQRT_MAX_UL 0xFFFFFFFFUL
+#define VLM_ICBRT_MAX_UL 2642245UL
+#else
+#define VLM_ISQRT_MAX_UL 0xFFFFUL
+#define VLM_ICBRT_MAX_UL 1625UL
+#endif
 
 /// @brief Returns the number of digits in an integer.
 /// @details Internally repeatedly divides the number by 10 mathematically -
@@ -128,4 +138,99 @@ inline int vlm_getFibonacciI(int mValue)
     return result;
 }
 
+/// @brief Returns floor(sqrt(mValue)), exactly.
+/// @details Internally uses a double-precision estimate, which is clamped and
+/// then corrected by at most one step in either direction. The correction
+/// makes the result exact even above 2^53, where the conversion to double
+/// rounds the input.
+/// @param mValue Number to use.
+static inline unsigned long vlm_isqrtUL(unsigned long mValue)
+{
+    unsigned long result = (unsigned long)sqrt((double)mValue);
+    if(result > VLM_ISQRT_MAX_UL) result = VLM_ISQRT_MAX_UL;
+
+    result -= result * result > mValue;
+    result += result < VLM_ISQRT_MAX_UL && (result + 1) * (result + 1) <= mValue;
+    return result;
+}
+
+/// @brief Returns floor(cbrt(mValue)), exactly.
+/// @details Internally uses a double-precision estimate, which is clamped and
+/// then corrected with integer arithmetic only.
+/// @param mValue Number to use.
+static inline unsigned long vlm_icbrtUL(unsigned long mValue)
+{
+    unsigned long result = (unsigned long)cbrt((double)mValue);
+    if(result > VLM_ICBRT_MAX_UL) result = VLM_ICBRT_MAX_UL;
+
+    while(result * result * result > mValue) --result;
+    while(result < VLM_ICBRT_MAX_UL &&
+          (result + 1) * (result + 1) * (result + 1) <= mValue)
+        ++result;
+    return result;
+}
+
+/// @brief Returns true if mValue is a perfect square.
+/// @details Rejects most non-squares with a quadratic residue mask (squares
+/// can only take 12 different values mod 64) before computing the root.
+static inline bool vlm_isPerfectSquareUL(unsigned long mValue)
+{
+    unsigned long root;
+    if(!((0x0202021202030213ULL >> (mValue & 63)) & 1)) return false;
+
+    root = vlm_isqrtUL(mValue);
+    return root * root == mValue;
+}
+
+/// @brief Returns true if mValue is a perfect cube.
+static inline bool vlm_isPerfectCubeUL(unsigned long mValue)
+{
+    unsigned long root = vlm_icbrtUL(mValue);
+    return root * root * root == mValue;
+}
+
+/// @brief Computes floor(sqrt(x)) for every element of mSrc into mDst.
+/// @details Elements are independent and the correction step is branchless,
+/// so consecutive square roots overlap in the pipeline (and are vectorized
+/// where the target supports unsigned 64-bit to double conversions).
+/// @param mSrc Source array.
+/// @param mDst Target array, can be the same as mSrc.
+/// @param mSize Number of elements.
+static inline void vlm_isqrtBatchUL(
+    const unsigned long* mSrc, unsigned long* mDst, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i)
+    {
+        unsigned long value = mSrc[i];
+        unsigned long r = (unsigned long)sqrt((double)value);
+        r = r > VLM_ISQRT_MAX_UL ? VLM_ISQRT_MAX_UL : r;
+        r -= r * r > value;
+        r += (r < VLM_ISQRT_MAX_UL) & ((r + 1) * (r + 1) <= value);
+        mDst[i] = r;
+    }
+}
+
+/// @brief Computes floor(cbrt(x)) for every element of mSrc into mDst.
+/// @details Same structure as vlm_isqrtBatchUL: the estimate of cbrt is
+/// within one of the exact root, so a single branchless correction step in
+/// each direction is enough.
+/// @param mSrc Source array.
+/// @param mDst Target array, can be the same as mSrc.
+/// @param mSize Number of elements.
+static inline void vlm_icbrtBatchUL(
+    const unsigned long* mSrc, unsigned long* mDst, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i)
+    {
+        unsigned long value = mSrc[i];
+        unsigned long r = (unsigned long)cbrt((double)value);
+        r = r > VLM_ICBRT_MAX_UL ? VLM_ICBRT_MAX_UL : r;
+        r -= r * r * r > value;
+        r += (r < VLM_ICBRT_MAX_UL) & ((r + 1) * (r + 1) * (r + 1) <= value);
+        mDst[i] = r;
+    }
+}
+
 #endif
@@ -0,0 +1,370 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_UTILS_POLY
+#define VL_UTILS_POLY
+
+#include "VeeLib/Global/Common.h"
+#include <float.h>
+
+// Fused multiply-add is only used when the target has it in hardware:
+// otherwise `fmaf` is a (very slow) software routine.
+#ifdef FP_FAST_FMAF
+#define VLPOLY_MADF(mA, mB, mC) fmaf(mA, mB, mC)
+#else
+#define VLPOLY_MADF(mA, mB, mC) ((mA) * (mB) + (mC))
+#endif
+
+// Max number of coefficients accepted by vlpoly_estrinF
+#define VLPOLY_ESTRIN_MAX 32
+
+// Number of elements processed at a time by the array functions
+#define VLPOLY_BLOCK_SIZE 256
+
+// Coefficients are always stored in increasing degree order:
+// mCoeffs[0] + mCoeffs[1] * x + mCoeffs[2] * x^2 + ...
+
+/// @brief Evaluates a polynomial in mX using Horner's scheme.
+/// @param mCoeffs Coefficients, in increasing degree order.
+/// @param mCount Number of coefficients (degree + 1).
+/// @param mX Point to evaluate the polynomial at.
+static inline float vlpoly_hornerF(
+    const float* mCoeffs, size_t mCount, float mX)
+{
+    float result = 0.f;
+    while(mCount-- > 0) result = VLPOLY_MADF(result, mX, mCoeffs[mCount]);
+    return result;
+}
+
+/// @brief Evaluates a polynomial in mX using Estrin's scheme.
+/// @details Coefficients are combined in pairs with x, then x^2, x^4, ...
+/// The dependency chain is log2(mCount) long instead of mCount, which
+/// lets the multiplications of each level execute in parallel.
+/// @param mCoeffs Coefficients, in increasing degree order.
+/// @param mCount Number of coefficients (at most VLPOLY_ESTRIN_MAX).
+/// @param mX Point to evaluate the polynomial at.
+static inline float vlpoly_estrinF(
+    const float* mCoeffs, size_t mCount, float mX)
+{
+    float temp[VLPOLY_ESTRIN_MAX];
+    size_t i;
+
+    assert(mCount <= VLPOLY_ESTRIN_MAX);
+    if(mCount == 0) return 0.f;
+
+    for(i = 0; i + 1 < mCount; i += 2)
+        temp[i / 2] = VLPOLY_MADF(mCoeffs[i + 1], mX, mCoeffs[i]);
+    if(mCount % 2 != 0) temp[mCount / 2] = mCoeffs[mCount - 1];
+    mCount = (mCount + 1) / 2;
+
+    while(mCount > 1)
+    {
+        mX *= mX;
+
+        for(i = 0; i + 1 < mCount; i += 2)
+            temp[i / 2] = VLPOLY_MADF(temp[i + 1], mX, temp[i]);
+        if(mCount % 2 != 0) temp[mCount / 2] = temp[mCount - 1];
+        mCount = (mCount + 1) / 2;
+    }
+
+    return temp[0];
+}
+
+/// @brief Evaluates a polynomial for every element of mXs into mTarget.
+/// @details Elements are processed in blocks: every coefficient is applied
+/// to a whole block before moving to the next one, so the inner loop has
+/// no loop-carried dependency and is vectorized by the compiler.
+/// @param mCoeffs Coefficients, in increasing degree order.
+/// @param mCount Number of coefficients (degree + 1).
+/// @param mXs Points to evaluate the polynomial at.
+/// @param mTarget Target array, can be the same as mXs.
+/// @param mSize Number of points.
+static inline void vlpoly_hornerArrayF(const float* mCoeffs, size_t mCount,
+    const float* mXs, float* mTarget, size_t mSize)
+{
+    float xs[VLPOLY_BLOCK_SIZE], acc[VLPOLY_BLOCK_SIZE];
+    size_t begin, blockSize, i, k;
+
+    for(begin = 0; begin < mSize; begin += blockSize)
+    {
+        blockSize = mSize - begin < VLPOLY_BLOCK_SIZE ? mSize - begin
+                                                      : VLPOLY_BLOCK_SIZE;
+
+        for(i = 0; i < blockSize; ++i)
+        {
+            xs[i] = mXs[begin + i];
+            acc[i] = 0.f;
+        }
+
+        for(k = mCount; k-- > 0;)
+            for(i = 0; i < blockSize; ++i)
+                acc[i] = VLPOLY_MADF(acc[i], xs[i], mCoeffs[k]);
+
+        for(i = 0; i < blockSize; ++i) mTarget[begin + i] = acc[i];
+    }
+}
+
+// Implementation details: minimax coefficients and range reduction
+// constants used by the elementary functions below.
+
+// sin(r) ~= r + r^3 * P(r^2) on [-pi/4, pi/4]
+static const float vlpoly_impl_sinCoeffs[] = {
+    -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f};
+
+// cos(r) ~= 1 - r^2 / 2 + r^4 * P(r^2) on [-pi/4, pi/4]
+static const float vlpoly_impl_cosCoeffs[] = {
+    4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f};
+
+// exp(r) ~= 1 + r + r^2 * P(r) on [-ln(2) / 2, ln(2) / 2]
+static const float vlpoly_impl_expCoeffs[] = {5.0000001201e-1f,
+    1.6666665459e-1f, 4.1665795894e-2f, 8.3334519073e-3f, 1.3981999507e-3f,
+    1.9875691500e-4f};
+
+// log(1 + r) ~= r - r^2 / 2 + r^3 * P(r) on [sqrt(0.5) - 1, sqrt(2) - 1]
+static const float vlpoly_impl_logCoeffs[] = {3.3333331174e-1f,
+    -2.4999993993e-1f, 2.0000714765e-1f, -1.6668057665e-1f, 1.4249322787e-1f,
+    -1.2420140846e-1f, 1.1676998740e-1f, -1.1514610310e-1f, 7.0376836292e-2f};
+
+// pi/2 split in two parts (Cody-Waite), so that k * part 1 is exact
+#define VLPOLY_IMPL_PIO2_1 1.5707963267341256
+#define VLPOLY_IMPL_PIO2_2 6.0771005065061922e-11
+#define VLPOLY_IMPL_2OPI 0.63661977236758134
+
+// ln(2) split in two parts
+#define VLPOLY_IMPL_LN2_1 0.693359375f
+#define VLPOLY_IMPL_LN2_2 -2.12194440e-4f
+#define VLPOLY_IMPL_LOG2E 1.44269504088896341f
+
+// Adding and subtracting 1.5 * 2^23 (1.5 * 2^52) rounds a float (double) to
+// the nearest integer
+#define VLPOLY_IMPL_ROUNDER 12582912.f
+#define VLPOLY_IMPL_ROUNDER_D 6755399441055744.0
+
+// Domain limits of the elementary functions
+#define VLPOLY_TRIG_MAX 8192.f
+#define VLPOLY_EXP_MAX 88.72283f
+#define VLPOLY_EXP_MIN -87.33654f
+
+typedef union
+{
+    float f;
+    unsigned int u;
+} vlpoly_impl_Bits;
+
+/// @brief Implementation: reduces mX to r in [-pi/4, pi/4], returns k such
+/// that mX = k * pi/2 + r.
+/// @details The reduction is done in double precision: float arguments close
+/// to a multiple of pi/2 would otherwise lose most of the significant bits
+/// of r to cancellation. mX must be in the domain (see
+/// vlpoly_impl_inTrigDomainF): k would not fit an int beyond it.
+static inline int vlpoly_impl_reduceTrigF(float mX, float* mR)
+{
+    double x = mX;
+    double k =
+        (x * VLPOLY_IMPL_2OPI + VLPOLY_IMPL_ROUNDER_D) - VLPOLY_IMPL_ROUNDER_D;
+
+    *mR = (float)((x - k * VLPOLY_IMPL_PIO2_1) - k * VLPOLY_IMPL_PIO2_2);
+    return (int)k;
+}
+
+/// @brief Implementation: returns whether |mX| <= VLPOLY_TRIG_MAX (false
+/// for NaN).
+static inline int vlpoly_impl_inTrigDomainF(float mX)
+{
+    return fabsf(mX) <= VLPOLY_TRIG_MAX;
+}
+
+/// @brief Implementation: sin of a reduced argument r.
+static inline float vlpoly_impl_sinKernelF(float mR)
+{
+    float z = mR * mR;
+    return VLPOLY_MADF(mR * z, vlpoly_hornerF(vlpoly_impl_sinCoeffs, 3, z), mR);
+}
+
+/// @brief Implementation: cos of a reduced argument r.
+static inline float vlpoly_impl_cosKernelF(float mR)
+{
+    float z = mR * mR;
+    return VLPOLY_MADF(z * z, vlpoly_hornerF(vlpoly_impl_cosCoeffs, 3, z),
+        VLPOLY_MADF(-0.5f, z, 1.f));
+}
+
+/// @brief Implementation: picks the sin or cos kernel for quadrant mK.
+static inline float vlpoly_impl_quadrantF(int mK, float mR)
+{
+    float s = vlpoly_impl_sinKernelF(mR), c = vlpoly_impl_cosKernelF(mR);
+    float result = (mK & 1) ? c : s;
+    return (mK & 2) ? -result : result;
+}
+
+/// @brief Returns sin(mX), computed with a minimax polynomial.
+/// @details Max error: 2 ulp (1.55 ulp measured) for |mX| <=
+/// VLPOLY_TRIG_MAX (8192). Beyond that the two-part Cody-Waite range
+/// reduction is no longer exact, and libm's sinf is called instead.
+static inline float vlpoly_sinF(float mX)
+{
+    float r;
+    int k;
+
+    if(!vlpoly_impl_inTrigDomainF(mX)) return sinf(mX);
+
+    k = vlpoly_impl_reduceTrigF(mX, &r);
+    return vlpoly_impl_quadrantF(k, r);
+}
+
+/// @brief Returns cos(mX), computed with a minimax polynomial.
+/// @details Max error: 2 ulp (1.55 ulp measured) for |mX| <=
+/// VLPOLY_TRIG_MAX (8192), libm's cosf beyond that (see vlpoly_sinF).
+static inline float vlpoly_cosF(float mX)
+{
+    float r;
+    int k;
+
+    if(!vlpoly_impl_inTrigDomainF(mX)) return cosf(mX);
+
+    k = vlpoly_impl_reduceTrigF(mX, &r);
+    return vlpoly_impl_quadrantF(k + 1, r);
+}
+
+/// @brief Implementation: exp of an argument in [VLPOLY_EXP_MIN,
+/// VLPOLY_EXP_MAX].
+static inline float vlpoly_impl_expKernelF(float mX)
+{
+    vlpoly_impl_Bits scale;
+    float k, r, result;
+    int half;
+
+    k = (mX * VLPOLY_IMPL_LOG2E + VLPOLY_IMPL_ROUNDER) - VLPOLY_IMPL_ROUNDER;
+    r = (mX - k * VLPOLY_IMPL_LN2_1) - k * VLPOLY_IMPL_LN2_2;
+
+    result = VLPOLY_MADF(
+        r * r, vlpoly_hornerF(vlpoly_impl_expCoeffs, 6, r), r + 1.f);
+
+    // 2^k is built directly in the exponent bits; k spans [-126, 128], so
+    // the scaling is split in two halves that are always normal floats
+    half = (int)k / 2;
+    scale.u = (unsigned int)(half + 127) << 23;
+    result *= scale.f;
+    scale.u = (unsigned int)((int)k - half + 127) << 23;
+    return result * scale.f;
+}
+
+/// @brief Returns exp(mX), computed with a minimax polynomial.
+/// @details Max error: 1.5 ulp (1.28 ulp measured). Returns 0 below
+/// VLPOLY_EXP_MIN, where results would be subnormal, and +inf above
+/// VLPOLY_EXP_MAX.
+static inline float vlpoly_expF(float mX)
+{
+    if(mX > VLPOLY_EXP_MAX) return HUGE_VALF;
+    if(mX < VLPOLY_EXP_MIN) return 0.f;
+    return vlpoly_impl_expKernelF(mX);
+}
+
+/// @brief Returns log(mX), computed with a minimax polynomial.
+/// @details Max error: 1 ulp (0.81 ulp measured) for all positive finite
+/// inputs, subnormals included. Returns -inf for 0, NaN for negative inputs
+/// and +inf for +inf.
+static inline float vlpoly_logF(float mX)
+{
+    vlpoly_impl_Bits bits;
+    float e, r, z, result;
+    int exponent = 0;
+
+    if(!(mX > 0.f)) return mX == 0.f ? -HUGE_VALF : NAN;
+    if(mX == HUGE_VALF) return mX;
+
+    // Bring subnormals in the normal range
+    if(mX < FLT_MIN)
+    {
+        mX *= 8388608.f;
+        exponent = -23;
+    }
+
+    // Split mX in m * 2^e with m in [sqrt(0.5), sqrt(2))
+    bits.f = mX;
+    exponent += (int)(bits.u >> 23) - 126;
+    bits.u = (bits.u & 0x007FFFFFu) | 0x3F000000u;
+    if(bits.f < 0.70710678f)
+    {
+        --exponent;
+        bits.f += bits.f;
+    }
+
+    e = (float)exponent;
+    r = bits.f - 1.f;
+    z = r * r;
+
+    result = r * z * vlpoly_hornerF(vlpoly_impl_logCoeffs, 9, r);
+    result = VLPOLY_MADF(e, VLPOLY_IMPL_LN2_2, result);
+    result = VLPOLY_MADF(-0.5f, z, result);
+    return VLPOLY_MADF(e, VLPOLY_IMPL_LN2_1, r + result);
+}
+
+/// @brief Computes sin(x) for every element of mXs into mTarget.
+/// @details Same error bound as vlpoly_sinF, and the same fallback to libm
+/// for |x| > VLPOLY_TRIG_MAX: those elements take a branch to sinf, which is
+/// well predicted when they are rare. The range reduction and the
+/// polynomial are computed for every element without branches.
+static inline void vlpoly_sinArrayF(
+    const float* mXs, float* mTarget, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i)
+    {
+        float x = mXs[i], r;
+        int inDomain = vlpoly_impl_inTrigDomainF(x);
+        int k = vlpoly_impl_reduceTrigF(inDomain ? x : 0.f, &r);
+        float result = vlpoly_impl_quadrantF(k, r);
+        mTarget[i] = inDomain ? result : sinf(x);
+    }
+}
+
+/// @brief Computes cos(x) for every element of mXs into mTarget.
+/// @details Same error bound and fallback as vlpoly_cosF.
+static inline void vlpoly_cosArrayF(
+    const float* mXs, float* mTarget, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i)
+    {
+        float x = mXs[i], r;
+        int inDomain = vlpoly_impl_inTrigDomainF(x);
+        int k = vlpoly_impl_reduceTrigF(inDomain ? x : 0.f, &r);
+        float result = vlpoly_impl_quadrantF(k + 1, r);
+        mTarget[i] = inDomain ? result : cosf(x);
+    }
+}
+
+/// @brief Computes exp(x) for every element of mXs into mTarget.
+/// @details Same domain and error bound as vlpoly_expF. Out of range inputs
+/// are clamped and fixed up afterwards, so the loop body is branch-free.
+static inline void vlpoly_expArrayF(
+    const float* mXs, float* mTarget, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i)
+    {
+        float x = mXs[i];
+        float clamped = x > VLPOLY_EXP_MAX
+                            ? VLPOLY_EXP_MAX
+                            : (x < VLPOLY_EXP_MIN ? VLPOLY_EXP_MIN : x);
+        float result = vlpoly_impl_expKernelF(clamped);
+
+        result = x > VLPOLY_EXP_MAX ? HUGE_VALF : result;
+        mTarget[i] = x < VLPOLY_EXP_MIN ? 0.f : result;
+    }
+}
+
+/// @brief Computes log(x) for every element of mXs into mTarget.
+/// @details Same domain and error bound as vlpoly_logF. Special inputs
+/// (zero, negative, infinite and subnormal values) are handled by branches,
+/// which are well predicted when they are rare.
+static inline void vlpoly_logArrayF(
+    const float* mXs, float* mTarget, size_t mSize)
+{
+    size_t i;
+    for(i = 0; i < mSize; ++i) mTarget[i] = vlpoly_logF(mXs[i]);
+}
+
+#endif
@@ -0,0 +1,188 @@
+// Copyright (c) 2013-2014 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef VL_UTILS_VECTOR
+#define VL_UTILS_VECTOR
+
+#include <string.h>
+#include "VeeLib/Global/Common.h"
+#include "VeeLib/Utils/Allocator.h"
+
+// Growable arrays, generated for an element type by VLV_DEFINE(suffix,
+// type, inline capacity). The first `inline capacity` elements are stored
+// in the vector itself, so small vectors never allocate; past that, memory
+// comes from the VlAllocator given to vlv_init and the capacity doubles
+// every time it runs out, so n pushes cost O(n) copies overall:
+//     VlVectorI v;
+//     vlv_initI(&v, vlalloc_system());
+//     if(vlv_pushI(&v, 42) != 0) ... out of memory
+//     printf("%d\n", v.data[0]);
+//     vlv_freeI(&v);
+//
+// `data` points to `size` elements, with room for `capacity`. While the
+// elements are in the small buffer `data` points inside the vector, so a
+// vector must not be copied (copy a pointer to it instead).
+//
+// Generated functions (those returning int return 1 in case of error, out
+// of memory, leaving the vector unchanged):
+//      vlv_init:           initializes an empty vector
+//      vlv_free:           frees the memory, leaving the vector empty
+//      vlv_reserve:        makes room for at least n elements
+//      vlv_shrink:         reduces the capacity to the size, moving the
+//                          elements back to the small buffer if they fit
+//      vlv_push:           appends an element, growing if needed
+//      vlv_pushUnchecked:  appends an element without checking the capacity,
+//                          which must have been reserved (asserted)
+//      vlv_append:         appends n elements copied from an array
+//      vlv_resize:         changes the size, setting new elements to a value
+//      vlv_clear:          removes all the elements, keeping the capacity
+//
+// Vectors of int, char, float and double (suffixes I, C, F, D) are defined
+// here.
+
+// Capacity after growing from mCapacity to hold at least mNeeded elements
+static inline size_t vlv_impl_grow(size_t mCapacity, size_t mNeeded)
+{
+    size_t result = mCapacity * 2;
+    return result < mNeeded ? mNeeded : result;
+}
+
+// Frees mData unless it is the small buffer
+static inline void vlv_impl_release(void* mData, void* mSmall,
+    size_t mCapacity, size_t mElement, const VlAllocator* mA)
+{
+    if(mData != mSmall) mA->dealloc(mA->state, mData, mCapacity * mElement);
+}
+
+// Moves the mSize elements at mData to a buffer of mNewCapacity elements,
+// or to the small buffer if mNewCapacity is not larger than mInline, and
+// returns it (NULL in case of error, mData is left untouched)
+static inline void* vlv_impl_relocate(void* mData, void* mSmall,
+    size_t mInline, size_t mSize, size_t* mCapacity, size_t mNewCapacity,
+    size_t mElement, const VlAllocator* mA)
+{
+    void* result = mSmall;
+
+    assert(mSize <= mNewCapacity);
+
+    if(mNewCapacity <= mInline)
+        mNewCapacity = mInline;
+    else
+    {
+        if(mNewCapacity > (size_t)-1 / mElement) return NULL;
+        result = mA->alloc(mA->state, mNewCapacity * mElement);
+        if(result == NULL) return NULL;
+    }
+
+    if(result != mData)
+    {
+        if(mSize > 0) memcpy(result, mData, mSize * mElement);
+        vlv_impl_release(mData, mSmall, *mCapacity, mElement, mA);
+    }
+
+    *mCapacity = mNewCapacity;
+    return result;
+}
+
+#define VLV_DEFINE(mSuffix, mType, mInline)                                    \
+    typedef struct                                                             \
+    {                                                                          \
+        mType* data;                                                           \
+        size_t size, capacity;                                                 \
+        VlAllocator allocator;                                                 \
+        mType small[mInline];                                                  \
+    } VlVector##mSuffix;                                                       \
+                                                                               \
+    static inline void vlv_init##mSuffix(                                      \
+        VlVector##mSuffix* mV, VlAllocator mAllocator)                         \
+    {                                                                          \
+        mV->data = mV->small;                                                  \
+        mV->size = 0;                                                          \
+        mV->capacity = mInline;                                                \
+        mV->allocator = mAllocator;                                            \
+    }                                                                          \
+                                                                               \
+    static inline void vlv_free##mSuffix(VlVector##mSuffix* mV)                \
+    {                                                                          \
+        vlv_impl_release(                                                      \
+            mV->data, mV->small, mV->capacity, sizeof(mType), &mV->allocator); \
+        mV->data = mV->small;                                                  \
+        mV->size = 0;                                                          \
+        mV->capacity = mInline;                                                \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_impl_resize##mSuffix(                                \
+        VlVector##mSuffix* mV, size_t mCapacity)                               \
+    {                                                                          \
+        void* data = vlv_impl_relocate(mV->data, mV->small, mInline,           \
+            mV->size, &mV->capacity, mCapacity, sizeof(mType),                 \
+            &mV->allocator);                                                   \
+        if(data == NULL) return 1;                                             \
+        mV->data = (mType*)data;                                               \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_reserve##mSuffix(                                    \
+        VlVector##mSuffix* mV, size_t mCapacity)                               \
+    {                                                                          \
+        return mCapacity > mV->capacity &&                                     \
+               vlv_impl_resize##mSuffix(mV, mCapacity) != 0;                   \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_shrink##mSuffix(VlVector##mSuffix* mV)               \
+    {                                                                          \
+        return mV->data != mV->small && mV->capacity != mV->size &&            \
+               vlv_impl_resize##mSuffix(mV, mV->size) != 0;                    \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_push##mSuffix(VlVector##mSuffix* mV, mType mValue)   \
+    {                                                                          \
+        if(mV->size == mV->capacity &&                                         \
+            vlv_reserve##mSuffix(                                              \
+                mV, vlv_impl_grow(mV->capacity, mV->size + 1)) != 0)           \
+            return 1;                                                          \
+        mV->data[mV->size++] = mValue;                                         \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void vlv_pushUnchecked##mSuffix(                             \
+        VlVector##mSuffix* mV, mType mValue)                                   \
+    {                                                                          \
+        assert(mV->size < mV->capacity);                                       \
+        mV->data[mV->size++] = mValue;                                         \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_append##mSuffix(                                     \
+        VlVector##mSuffix* mV, const mType* mValues, size_t mCount)            \
+    {                                                                          \
+        if(mV->size + mCount > mV->capacity &&                                 \
+            vlv_reserve##mSuffix(                                              \
+                mV, vlv_impl_grow(mV->capacity, mV->size + mCount)) != 0)      \
+            return 1;                                                          \
+        if(mCount > 0)                                                         \
+            memcpy(mV->data + mV->size, mValues, mCount * sizeof(mType));      \
+        mV->size += mCount;                                                    \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline int vlv_resize##mSuffix(                                     \
+        VlVector##mSuffix* mV, size_t mSize, mType mValue)                     \
+    {                                                                          \
+        if(vlv_reserve##mSuffix(mV, mSize) != 0) return 1;                     \
+        while(mV->size < mSize) mV->data[mV->size++] = mValue;                 \
+        mV->size = mSize;                                                      \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void vlv_clear##mSuffix(VlVector##mSuffix* mV)               \
+    {                                                                          \
+        mV->size = 0;                                                          \
+    }
+
+VLV_DEFINE(I, int, 16)
+VLV_DEFINE(C, char, 64)
+VLV_DEFINE(F, float, 16)
+VLV_DEFINE(D, double, 16)
+
+#endif
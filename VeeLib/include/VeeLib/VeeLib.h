@@ -9,6 +9,10 @@
 #include "VeeLib/Utils/Utility.h"
 #include "VeeLib/Utils/Math.h"
 #include "VeeLib/Utils/Array.h"
+#include "VeeLib/Utils/Poly.h"
+#include "VeeLib/Utils/Arena.h"
+#include "VeeLib/Utils/Allocator.h"
+#include "VeeLib/Utils/Vector.h"
 #include "VeeLib/Utils/Console.h"
 #include "VeeLib/Deprecated/Deprecated.h"
 